@@ -18,8 +18,13 @@ build-driver:
 	make -C $(KERNEL_SOURCES) M=$(SRC_DIR) ARCH=$(ARCH) CROSS_COMPILE=$(CROSS_COMPILE) EXTRA_CFLAGS="$(EXTRA_CFLAGS)" modules
 	mv $(SRC_DIR)/i2c-psoc4-driver.ko $(OUT_DIR)/i2c-psoc4-driver.ko
 
+build-tests:
+	make -C $(KERNEL_SOURCES) M=$(TEST_DIR) ARCH=$(ARCH) CROSS_COMPILE=$(CROSS_COMPILE) EXTRA_CFLAGS="$(EXTRA_CFLAGS)" modules
+	mv $(TEST_DIR)/*.ko $(OUT_DIR)/
+
 dt:
 	dtc -I dts -O dtb -o $(OUT_DIR)/psoc4-capsense.dtbo $(SRC_DIR)/psoc4-capsense.dts
 
 clean:
 	make -C $(KERNEL_SOURCES) M=$(SRC_DIR) ARCH=$(ARCH) CROSS_COMPILE=$(CROSS_COMPILE) clean
+	make -C $(KERNEL_SOURCES) M=$(TEST_DIR) ARCH=$(ARCH) CROSS_COMPILE=$(CROSS_COMPILE) clean
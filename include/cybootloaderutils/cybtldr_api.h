@@ -71,6 +71,18 @@ struct CyBtldr_CommunicationsData {
 	unsigned int MaxTransferSize;
 };
 
+/**
+ * This struct holds the command and response buffers shared by all
+ * commands of one bootload operation, so they are allocated once per
+ * update instead of once per command.
+ */
+struct CyBtldr_Session {
+	/** Command packet sent to the device */
+	u8 inBuf[MAX_COMMAND_SIZE];
+	/** Response packet read from the device */
+	u8 outBuf[MAX_COMMAND_SIZE];
+};
+
 /**
  * This struct defines response structure for custom command
  * defined by user.
@@ -165,6 +177,36 @@ int CyBtldr_WriteData(u8 *inBuf, int inSize);
  *******************************************************************************/
 int CyBtldr_ReadData(u8 *outBuf, int outSize);
 
+/*******************************************************************************
+ * Function Name: CyBtldr_CreateSession
+ ********************************************************************************
+ * Summary:
+ *   Allocates the buffers used by the commands of a bootload operation. This
+ *   must be called before CyBtldr_StartBootloadOperation(), and a corresponding
+ *   call to CyBtldr_DestroySession() made once the operation is complete.
+ *
+ * Parameters:
+ *   void.
+ *
+ * Returns:
+ *   CYRET_SUCCESS  - The session was created successfully
+ *   -ENOMEM        - The buffers could not be allocated
+ *
+ *******************************************************************************/
+EXTERN int CyBtldr_CreateSession(void);
+
+/*******************************************************************************
+ * Function Name: CyBtldr_DestroySession
+ ********************************************************************************
+ * Summary:
+ *   Releases the buffers allocated by CyBtldr_CreateSession().
+ *
+ * Parameters:
+ *   void.
+ *
+ *******************************************************************************/
+EXTERN void CyBtldr_DestroySession(void);
+
 /*******************************************************************************
  * Function Name: CyBtldr_StartBootloadOperation
  ********************************************************************************
@@ -75,7 +75,7 @@ typedef void CyBtldr_ProgressUpdate(double percentage);
  *   action         - The action to execute
  *   comm           - Communication struct used for communicating with the target device
  *   update         - Optional function pointer to use to notify of progress updates
- *   file           - The full canonical path to the *.cyacd file to open
+ *   image          - The *.cyacd2 image decoded with CyBtldr_ParseImage()
  *
  * Returns:
  *   CYRET_SUCCESS	    - The device was programmed successfully
@@ -92,7 +92,7 @@ typedef void CyBtldr_ProgressUpdate(double percentage);
  *
  *******************************************************************************/
 int CyBtldr_RunAction(enum CyBtldr_Action action, struct CyBtldr_CommunicationsData *comm,
-						CyBtldr_ProgressUpdate *update, const char *file);
+						CyBtldr_ProgressUpdate *update, const struct CyBtldr_Image *image);
 
 /*******************************************************************************
  * Function Name: CyBtldr_Program
@@ -102,7 +102,7 @@ int CyBtldr_RunAction(enum CyBtldr_Action action, struct CyBtldr_CommunicationsD
  *   the contents of the provided *.cyacd file.
  *
  * Parameters:
- *   file        - The full canonical path to the *.cyacd file to open
+ *   image       - The *.cyacd2 image decoded with CyBtldr_ParseImage()
  *   comm        - Communication struct used for communicating with the target device
  *   update      - Optional function pointer to use to notify of progress updates
  *
@@ -119,7 +119,8 @@ int CyBtldr_RunAction(enum CyBtldr_Action action, struct CyBtldr_CommunicationsD
  *   CYRET_ABORT		    - The operation was aborted
  *
  *******************************************************************************/
-EXTERN int CALL_CON CyBtldr_Program(const char *file, struct CyBtldr_CommunicationsData *comm,
+EXTERN int CALL_CON CyBtldr_Program(const struct CyBtldr_Image *image,
+								struct CyBtldr_CommunicationsData *comm,
 								CyBtldr_ProgressUpdate *update);
 
 /*******************************************************************************
@@ -131,7 +132,7 @@ EXTERN int CALL_CON CyBtldr_Program(const char *file, struct CyBtldr_Communicati
  *
  *
  * Parameters:
- *   file        – The full canonical path to the *.cyacd file to open
+ *   image       – The *.cyacd2 image decoded with CyBtldr_ParseImage()
  *   comm        – Communication struct used for communicating with the target device
  *   update      - Optional function pointer to use to notify of progress updates
  *
@@ -148,7 +149,8 @@ EXTERN int CALL_CON CyBtldr_Program(const char *file, struct CyBtldr_Communicati
  *   CYRET_ABORT		    - The operation was aborted
  *
  *******************************************************************************/
-EXTERN int CALL_CON CyBtldr_Erase(const char *file, struct CyBtldr_CommunicationsData *comm,
+EXTERN int CALL_CON CyBtldr_Erase(const struct CyBtldr_Image *image,
+								struct CyBtldr_CommunicationsData *comm,
 								CyBtldr_ProgressUpdate *update);
 
 /*******************************************************************************
@@ -165,7 +167,7 @@ EXTERN int CALL_CON CyBtldr_Erase(const char *file, struct CyBtldr_Communication
  *   occurred.
  *
  * Parameters:
- *   file        – The full canonical path to the *.cyacd file to open
+ *   image       – The *.cyacd2 image decoded with CyBtldr_ParseImage()
  *   comm        – Communication struct used for communicating with the target device
  *   update      - Optional function pointer to use to notify of progress updates
  *
@@ -183,7 +185,8 @@ EXTERN int CALL_CON CyBtldr_Erase(const char *file, struct CyBtldr_Communication
  *   CYRET_ABORT		    - The operation was aborted
  *
  *******************************************************************************/
-EXTERN int CALL_CON CyBtldr_Verify(const char *file, struct CyBtldr_CommunicationsData *comm,
+EXTERN int CALL_CON CyBtldr_Verify(const struct CyBtldr_Image *image,
+								struct CyBtldr_CommunicationsData *comm,
 								CyBtldr_ProgressUpdate *update);
 
 /*******************************************************************************
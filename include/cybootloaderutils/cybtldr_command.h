@@ -110,6 +110,18 @@ enum CyBtldr_ChecksumType {
 
 EXTERN void fillData32(u8 *buf, u32 data);
 
+/*******************************************************************************
+ * Function Name: CyBtldr_InitChecksum
+ ********************************************************************************
+ * Summary:
+ *   Prepares the CRC-32C implementation used by CyBtldr_ComputeChecksum32bit.
+ *   The kernel crc32c() is used when it is available, otherwise the lookup
+ *   tables for slicing by 8 bytes are generated. Must be called once before
+ *   any checksum is computed.
+ *
+ *******************************************************************************/
+void CyBtldr_InitChecksum(void);
+
 /*******************************************************************************
  * Function Name: CyBtldr_ComputeChecksum16bit
  ********************************************************************************
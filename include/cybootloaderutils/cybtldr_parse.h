@@ -55,6 +55,40 @@
  */
 #define MAX_BUFFER_SIZE 768
 
+/* Returned by CyBtldr_FromHex() for a char that is not a hexadecimal digit */
+#define CYBTLDR_HEX_INVALID 0xFF
+
+/* Kind of a decoded row of the *.cyacd2 image */
+enum CyBtldr_RowType {
+	/* Flash row data, a ':' line */
+	CYBTLDR_ROW_DATA,
+	/* Encryption initial vector, an @EIV line */
+	CYBTLDR_ROW_EIV,
+};
+
+/* Decoded row of the *.cyacd2 image */
+struct CyBtldr_Row {
+	u8 type;		/* enum CyBtldr_RowType */
+	u8 checksum;		/* Sum of the data bytes */
+	u16 size;		/* Number of bytes in data */
+	u32 address;		/* Flash address of the data, CYBTLDR_ROW_DATA only */
+	const u8 *data;		/* Decoded bytes, points into the data of the image */
+};
+
+/* *.cyacd2 image decoded into binary rows */
+struct CyBtldr_Image {
+	u32 siliconId;
+	u8 siliconRev;
+	u8 chksumType;
+	u8 appId;
+	u64 productId;
+	u32 appStart;		/* From @APPINFO, or the lowest row address */
+	u32 appSize;		/* From @APPINFO, or the sum of all row sizes */
+	u32 numRows;		/* Data and EIV rows, in file order */
+	struct CyBtldr_Row *rows;
+	u8 *data;		/* Decoded bytes of all rows */
+};
+
 /*******************************************************************************
  * Function Name: CyBtldr_FromHex
  ********************************************************************************
@@ -66,7 +100,7 @@
  *
  * Returns:
  *   The hexadecimal numerical equivalent of the provided ASCII char.  If the
- *   provided char is not a valid ASCII char, it will return 0.
+ *   provided char is not a hexadecimal digit, it will return CYBTLDR_HEX_INVALID.
  *
  *******************************************************************************/
 u8 CyBtldr_FromHex(char value);
@@ -86,49 +120,10 @@ u8 CyBtldr_FromHex(char value);
  * Returns:
  *   CYRET_SUCCESS    - The buffer was converted successfully
  *   CYRET_ERR_LENGTH - The buffer does not have an even number of chars
+ *   CYRET_ERR_DATA   - The buffer contains a char that is not a hexadecimal digit
  *
  *******************************************************************************/
-int CyBtldr_FromAscii(u32 bufSize, char *buffer, u16 *rowSize, u8 *rowData);
-
-/*******************************************************************************
- * Function Name: CyBtldr_ReadLine
- ********************************************************************************
- * Summary:
- *   Reads a single line from the open data file.  This function will remove
- *   any Windows, Linux, or Unix line endings from the data.
- *
- * Parameters:
- *   size - The number of bytes of data read from the line and stored in buffer
- *   file - The preallocated buffer, with MAX_BUFFER_SIZE bytes, to store the
- *          read data in.
- *
- * Returns:
- *   CYRET_SUCCESS  - The file was opened successfully.
- *   CYRET_ERR_FILE - An error occurred opening the provided file.
- *   CYRET_ERR_EOF  - The end of the file has been reached
- *
- *******************************************************************************/
-EXTERN int CyBtldr_ReadLine(u32 *size, char *buffer);
-
-/*******************************************************************************
- * Function Name: CyBtldr_OpenDataFile
- ********************************************************************************
- * Summary:
- *   Opens the provided file for reading.  Once open, it is expected that the
- *   first call will be to ParseHeader() to read the first line of data.  After
- *   that, successive calls to ParseRowData() are possible to read each line
- *   of data, one at a time, from the file.  Once all data has been read from
- *   the file, a call to CloseDataFile() should be made to release resources.
- *
- * Parameters:
- *   file - The full canonical path to the *.cyacd file to open
- *
- * Returns:
- *   CYRET_SUCCESS  - The file was opened successfully.
- *   CYRET_ERR_FILE - An error occurred opening the provided file.
- *
- *******************************************************************************/
-EXTERN int CyBtldr_OpenDataFile(const char *file);
+int CyBtldr_FromAscii(u32 bufSize, const char *buffer, u16 *rowSize, u8 *rowData);
 
 /*******************************************************************************
  * Function Name: CyBtldr_ParseCyacdFileVersion
@@ -136,7 +131,7 @@ EXTERN int CyBtldr_OpenDataFile(const char *file);
  * Summary:
  *   Parses the header information from the *.cyacd file.  The header information
  *   is stored as the first line, so this method should only be called once,
- *   and only immediately after calling OpenDataFile and reading the first line.
+ *   and only on the first line of the image.
  *
  * Parameters:
  *   bufSize    - The number of bytes contained within buffer
@@ -145,9 +140,10 @@ EXTERN int CyBtldr_OpenDataFile(const char *file);
  * Returns:
  *   CYRET_SUCCESS    - The file was opened successfully.
  *   CYRET_ERR_LENGTH - The line does not contain enough data
+ *   CYRET_ERR_DATA   - The line is not a supported header
  *
  *******************************************************************************/
-EXTERN int CyBtldr_CheckCyacdFileVersion(u32 bufSize, char *buffer, u8 *version);
+EXTERN int CyBtldr_CheckCyacdFileVersion(u32 bufSize, const char *buffer, u8 *version);
 
 /*******************************************************************************
  * Function Name: CyBtldr_ParseHeader
@@ -155,7 +151,7 @@ EXTERN int CyBtldr_CheckCyacdFileVersion(u32 bufSize, char *buffer, u8 *version)
  * Summary:
  *   Parses the header information from the *.cyacd2 file.  The header information
  *   is stored as the first line, so this method should only be called once,
- *   and only immediately after calling OpenDataFile and reading the first line.
+ *   and only on the first line of the image.
  *   This function is only used for applications using the .cyacd2 format.
  *
  * Parameters:
@@ -170,74 +166,47 @@ EXTERN int CyBtldr_CheckCyacdFileVersion(u32 bufSize, char *buffer, u8 *version)
  * Returns:
  *   CYRET_SUCCESS    - The file was opened successfully.
  *   CYRET_ERR_LENGTH - The line does not contain enough data
+ *   CYRET_ERR_DATA   - The line contains a char that is not a hexadecimal digit
  *
  *******************************************************************************/
-EXTERN int CyBtldr_ParseHeader(u32 bufSize, char *buffer, u32 *siliconId, u8 *siliconRev,
+EXTERN int CyBtldr_ParseHeader(u32 bufSize, const char *buffer, u32 *siliconId, u8 *siliconRev,
 							u8 *chksum, u8 *appID, u64 *productID);
 
 /*******************************************************************************
- * Function Name: CyBtldr_ParseCyAcd2RowData
- ********************************************************************************
- * Summary:
- *   Parses the contents of the provided buffer which is expected to contain
- *   the row data from the *.cyacd2 file.  This is expected to be called multiple
- *   times.  Once for each row of the *.cyacd2 file, excluding the header row.
- *   This function is only used for applications using the .cyacd2 format.
- *
- * Parameters:
- *   bufSize     - The number of bytes contained within buffer
- *   buffer      - The buffer containing the row data to parse
- *   address     - The flash address that the data belongs in
- *   rowData     - The preallocated buffer to store the flash row data
- *   size        - The number of bytes of rowData
- *   checksum    - The sum-checksum value for the entire row's data rowData
- *
- * Returns:
- *   CYRET_SUCCESS    - The file was opened successfully.
- *   CYRET_ERR_LENGTH - The line does not contain enough data
- *   CYRET_ERR_DATA   - The line does not contain a full row of data
- *   CYRET_ERR_CMD    - The line does not start with the cmd identifier ':'
- *
- *******************************************************************************/
-EXTERN int CyBtldr_ParseCyAcd2RowData(u32 bufSize, char *buffer, u32 *address, u8 *rowData,
-								u16 *size, u8 *checksum);
-
-/*******************************************************************************
- * Function Name: CyBtldr_ParseCyAcdAppStartAndSize
+ * Function Name: CyBtldr_ParseImage
  ********************************************************************************
  * Summary:
- *   Parse the cyacd2 application's start address and size.
- *   This function need to be called after parsing the header and EIV row and before any data row.
- *   When this function returns, the file point will be set to the row after header row.
+ *   Decodes the *.cyacd2 image in a single pass: the header, the @APPINFO
+ *   application start and size, and all data and @EIV rows in file order.
+ *   The returned image does not reference buf, and must be released with
+ *   CyBtldr_FreeImage().
  *
  * Parameters:
- *   appStart     - The application start address
- *   appSize      - The number of bytes in the application.
- *   dataLines    - The number of data lines in the application's file.
- *   buf          - The buffer containing the data to parse.
+ *   buf      - The contents of the *.cyacd2 file
+ *   size     - The number of bytes in buf
+ *   image    - The decoded image
  *
  * Returns:
- *   CYRET_SUCCESS    - The file was opened successfully.
- *   CYRET_ERR_FILE   - The file cannot be read successfully.
+ *   CYRET_SUCCESS    - The image was decoded successfully.
+ *   CYRET_ERR_FILE   - The image is empty, has an invalid @APPINFO, contains an
+ *                      unknown line, or is out of memory.
+ *   CYRET_ERR_EOF    - The image does not contain a header.
+ *   CYRET_ERR_LENGTH - A line is too long or too short.
+ *   CYRET_ERR_DATA   - A line does not contain valid data.
  *
  *******************************************************************************/
-EXTERN int CyBtldr_ParseCyAcdAppStartAndSize(u32 *appStart, u32 *appSize, u32 *dataLines,
-										char *buf);
+EXTERN int CyBtldr_ParseImage(const u8 *buf, u32 size, struct CyBtldr_Image **image);
 
 /*******************************************************************************
- * Function Name: CyBtldr_CloseDataFile
+ * Function Name: CyBtldr_FreeImage
  ********************************************************************************
  * Summary:
- *   Closes the data file pointer.
+ *   Releases an image decoded with CyBtldr_ParseImage().
  *
  * Parameters:
- *   void.
- *
- * Returns:
- *   CYRET_SUCCESS  - The file was opened successfully.
- *   CYRET_ERR_FILE - An error occurred opening the provided file.
+ *   image    - The decoded image, may be NULL
  *
  *******************************************************************************/
-EXTERN int CyBtldr_CloseDataFile(void);
+EXTERN void CyBtldr_FreeImage(struct CyBtldr_Image *image);
 
 #endif
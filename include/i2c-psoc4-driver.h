@@ -55,6 +55,7 @@
 #include <linux/of.h>
 #include <linux/interrupt.h>
 #include <linux/of_irq.h>
+#include <linux/irq.h>
 #include <linux/input.h>
 #include <linux/input/mt.h>
 #include <linux/fs.h>
@@ -67,9 +68,26 @@
 #include <linux/debugfs.h>
 #include <linux/uaccess.h>
 #include <linux/slab.h>
-#include <net/sock.h>
+#include <linux/mutex.h>
+#include <linux/cache.h>
+#include <linux/ktime.h>
+#include <linux/hrtimer.h>
+#include <linux/workqueue.h>
+#include <linux/kfifo.h>
+#include <linux/kref.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
+#include <linux/miscdevice.h>
+#include <linux/idr.h>
+#include <linux/firmware.h>
+#include <net/genetlink.h>
 
 #include "psoc4-i2c.h"
+#include "psoc4-genl.h"
+#include "psoc4-ring.h"
+#include "psoc4-capture.h"
 #include "i2c-reg-map.h"
 #include "cybootloaderutils/cybtldr_api.h"
 
@@ -125,10 +143,23 @@
 #define DFU_MAX_RETRY		10
 #define DFU_READ_TIMEOUT_MS	300
 
-// Netlink message type
-#define NETLINK_USER_TYPE	31
-#define NETLINK_GROUP 		1
-#define NETLINK_MSG_LEN		64
+// Frame polling rate if SNS_REF_RATE_ACT cannot be read
+#define POLL_DEFAULT_RATE_HZ	60
+
+// Maximum number of frames handled by one IRQ thread invocation
+#define IRQ_DRAIN_BUDGET	8
+
+// Number of frames queued for the netlink worker, must be a power of 2
+#define NL_EVENT_FIFO_SIZE	32
+
+// Upper limit of the netlink event coalescing window
+#define NL_COALESCE_MAX_MS	1000
+
+// Size of the sensor capture fifo in bytes, must be a power of 2
+#define CAPTURE_FIFO_SIZE	32768
+
+// Time limit for clearing pending interrupts
+#define IRQ_CLEAR_TIMEOUT_MS	100
 
 // Touch coordinates structure
 struct psoc4_touch {
@@ -137,6 +168,90 @@ struct psoc4_touch {
 	u16 z;
 };
 
+// Data of a single interrupt frame
+struct psoc4_frame {
+	u8 int_status;
+	u8 num_touches;
+	struct psoc4_touch touches[NUM_TOUCH_SLOTS];
+	u32 gestures;
+};
+
+// Frame queued for the netlink worker
+struct psoc4_nl_event {
+	ktime_t time;		// Timestamp of the frame
+	u32 seq;		// Sequence number of the frame
+	u8 groups;		// Multicast groups to send the frame to
+	struct psoc4_frame frame;
+};
+
+// Time spent in the IRQ thread
+struct psoc4_irq_time_stats {
+	u64 last_ns;
+	u64 max_ns;
+	u64 total_ns;
+	u64 count;
+};
+
+// Per-device DFU state
+struct psoc4_dfu_state {
+	u32 address;		// I2C address of the bootloader
+	bool packet_started;	// Tracks status of reading response packet
+	bool success;		// Tracks if DFU update was successful
+};
+
+struct psoc4_ring;
+struct psoc4_capture;
+struct iio_dev;
+
+// Per-device driver data
+struct psoc4_data {
+	struct i2c_client *client;
+	int id;			// Device number used in netlink events
+	struct input_dev *input_dev;
+	struct miscdevice misc;	// /dev/psoc4-N frame ring
+	struct psoc4_ring *ring;
+	struct dentry *debugfs_dir;
+	struct psoc4_capture *capture; // sns_stream capture, guarded by the event lock
+	struct mutex sns_lock;	// Guards the sensor snapshot
+	struct psoc4_sns_snapshot sns_snapshot; // Buffer of the sensor debugfs files
+	struct iio_dev *indio_dev; // Sensor data IIO device, IIO_SENSOR_DATA only
+	int irq;
+	ktime_t irq_time;	// Set by the hard IRQ handler
+	ktime_t event_time;	// Timestamp of the events being reported
+	struct mutex event_lock; // Serializes the IRQ thread and frame polling
+	struct hrtimer poll_timer;
+	struct work_struct poll_work;
+	ktime_t poll_time;	// Expiry time of the poll timer
+	ktime_t poll_next;	// Next poll, locked to the scan period
+	u64 poll_period;	// Scan period in ns
+	bool poll_only;		// No IRQ available, frames are always polled
+	bool polling;		// Poll timer is armed
+	bool poll_touching;	// Touches were reported by the last poll
+	struct psoc4_irq_time_stats irq_time_stats; // Guarded by the event lock
+	unsigned int scan_irq_users; // Users of the scan complete interrupt, guarded by the event lock
+	u8 scan_irq_saved;	// SCAN_COMPLETE bit of INT_SRC_EN before the first user
+	struct list_head nl_node; // Entry in the list of netlink configurable devices
+	unsigned int nl_config_users; // Running configuration requests, guarded by the device list lock
+	wait_queue_head_t nl_config_wait; // Woken when the last configuration request ends
+	struct mutex nl_config_lock; // Serializes the configuration requests of the device
+	u32 nl_seq;		// Sequence number of the next netlink event
+	DECLARE_KFIFO(nl_fifo, struct psoc4_nl_event, NL_EVENT_FIFO_SIZE);
+	struct work_struct nl_work; // Sends the events queued in nl_fifo
+	atomic_long_t nl_drops;	// Events lost because nl_fifo was full
+	struct mutex nl_lock;	// Guards the netlink event batch
+	struct sk_buff *nl_batch[PSOC4_GENL_MCGRP_COUNT]; // Events collected in the coalescing window
+	struct delayed_work nl_flush_work;
+	unsigned int nl_coalesce_ms; // Coalescing window, 0 if disabled
+	struct psoc4_dfu_state dfu;
+	struct regmap *regmap;
+	struct psoc4_reg_cache_stats reg_cache_stats;
+	struct psoc4_retry_policy retry_policy;
+	struct psoc4_i2c_error_stats i2c_error_stats;
+	struct mutex lock; // Guards the register map, transfer buffer and retry policy
+	// DMA-safe transfer buffer on its own cacheline
+	u8 xfer_buf[PSOC4_XFER_BUF_SIZE] ____cacheline_aligned;
+};
+
 // General functions
 int init_psoc4_config(struct i2c_client *client);
 
@@ -146,7 +261,7 @@ void psoc4_sysfs_remove(struct i2c_client *client);
 
 // DebugFS functions
 int psoc4_debugfs_create(struct i2c_client *client);
-void psoc4_debugfs_remove(void);
+void psoc4_debugfs_remove(struct i2c_client *client);
 
 // Input subsystem functions
 int psoc4_input_dev_create(struct i2c_client *client);
@@ -156,22 +271,54 @@ void psoc4_input_report_coord(struct i2c_client *client, u8 num_touches,
 void psoc4_input_report_gesture(struct i2c_client *client, u32 gestures);
 void psoc4_input_report_liftoff_touchdown(struct i2c_client *client,
 								u8 num_touches);
-void report_instant_event(u32 key_code);
+void report_instant_event(struct i2c_client *client, u32 key_code);
+
+// Frame ring functions
+int psoc4_ring_create(struct i2c_client *client);
+void psoc4_ring_remove(struct i2c_client *client);
+void psoc4_ring_push(struct i2c_client *client, struct psoc4_frame *frame);
+
+// Sensor capture functions
+void psoc4_capture_create(struct i2c_client *client, struct dentry *dir);
+void psoc4_capture_remove(struct i2c_client *client);
+void psoc4_capture_scan(struct i2c_client *client);
+
+// IIO functions
+#if defined(IIO_SENSOR_DATA)
+int psoc4_iio_create(struct i2c_client *client);
+void psoc4_iio_remove(struct i2c_client *client);
+void psoc4_iio_scan(struct i2c_client *client);
+#else
+static inline int psoc4_iio_create(struct i2c_client *client) { return 0; }
+static inline void psoc4_iio_remove(struct i2c_client *client) { }
+static inline void psoc4_iio_scan(struct i2c_client *client) { }
+#endif /* #if defined(IIO_SENSOR_DATA) */
 
 // IRQ functions
 int psoc4_irq_register(struct i2c_client *client);
 int psoc4_irq_clear(struct i2c_client *client);
-int psoc4_touch_detected_handler(struct i2c_client *client);
-int psoc4_gesture_detected_handler(struct i2c_client *client);
-int psoc4_liftoff_touchdown_handler(struct i2c_client *client);
+int psoc4_scan_irq_get(struct i2c_client *client);
+void psoc4_scan_irq_put(struct i2c_client *client);
+void psoc4_poll_stop(struct i2c_client *client);
+int psoc4_touch_detected_handler(struct i2c_client *client, struct psoc4_frame *frame);
+int psoc4_gesture_detected_handler(struct i2c_client *client, struct psoc4_frame *frame);
+int psoc4_liftoff_touchdown_handler(struct i2c_client *client, struct psoc4_frame *frame);
 
 // Netlink functions
+int psoc4_nl_init(void);
 void psoc4_nl_exit(void);
+void psoc4_nl_dev_init(struct i2c_client *client);
+void psoc4_nl_dev_add(struct i2c_client *client);
+void psoc4_nl_dev_remove(struct i2c_client *client);
+void psoc4_nl_queue_event(struct i2c_client *client, struct psoc4_frame *frame);
+void psoc4_nl_set_coalesce(struct i2c_client *client, unsigned int window_ms);
+unsigned int psoc4_nl_get_coalesce(struct i2c_client *client);
+void psoc4_nl_show_subscriptions(struct seq_file *s);
 
 // DFU functions
-int psoc4_dfu_start(struct i2c_client *client);
+void psoc4_dfu_init(struct i2c_client *client);
+int psoc4_dfu_update(struct i2c_client *client, const char *fw_name);
 int psoc4_dfu_jump_to_bootloader(struct i2c_client *client);
-int psoc4_dfu_program(char *dfu_filepath);
-bool psoc4_dfu_get_status(void);
+bool psoc4_dfu_get_status(struct i2c_client *client);
 
 #endif // I2C_PSOC4_H
@@ -85,6 +85,15 @@
 #define REG_SNS_BSLN(x)			(REG_SNS_RAW + REG_SNS_RAW_SIZE(x))
 #define REG_SNS_CP_MEASURE(x)	(REG_SNS_RAW + REG_SNS_RAW_SIZE(x) + REG_SNS_BSLN_SIZE(x))
 
+// Block holding all configuration registers, INT_SRC_EN to SNS_REF_RATE_ALR
+#define REG_CONFIG				(REG_INT_SRC_EN)
+#define REG_CONFIG_SIZE			(REG_SNS_REF_RATE_ALR - REG_CONFIG + 1)
+
+// Touch report block: TCH0/TCH1 coordinates, NUM_TOUCH and GESTURE_DET
+#define REG_TCH_FRAME			(REG_TCH0_POS_X)
+#define REG_TCH_FRAME_NUM_TOUCH_OFFSET	(REG_NUM_TOUCH - REG_TCH_FRAME)
+#define REG_TCH_FRAME_GESTURE_OFFSET	(REG_GESTURE_DET - REG_TCH_FRAME)
+
 // Register sizes
 #define REG_FW_VER_SIZE		(REG_FW_VER_MAJ_SIZE + \
 							REG_FW_VER_MIN_SIZE + \
@@ -116,10 +125,21 @@
 #define REG_TCH1_POS_Z_SIZE					2
 #define REG_NUM_TOUCH_SIZE					1
 #define REG_GESTURE_DET_SIZE				4
+#define REG_TCH_FRAME_SIZE					(REG_GESTURE_DET + REG_GESTURE_DET_SIZE - \
+											REG_TCH_FRAME)
 #define REG_STORED_FLAG_SIZE				1
 #define REG_NUM_SNS_SIZE					1
 #define REG_SNS_RAW_SIZE(x)					(2 * x)
 #define REG_SNS_BSLN_SIZE(x)				(2 * x)
 #define REG_SNS_CP_MEASURE_SIZE(x)			(4 * x)
+// Raw counts, baselines and Cp measurements are adjacent from SNS_RAW
+#define REG_SNS_DATA_SIZE(x)				(REG_SNS_RAW_SIZE(x) + \
+											REG_SNS_BSLN_SIZE(x) + \
+											REG_SNS_CP_MEASURE_SIZE(x))
+
+// Sensor data must fit into the 8-bit register address space
+#define PSOC4_MAX_SNS		((0x100 - REG_SNS_RAW) / REG_SNS_DATA_SIZE(1))
+#define PSOC4_REG_MAX		(REG_SNS_CP_MEASURE(PSOC4_MAX_SNS) + \
+							REG_SNS_CP_MEASURE_SIZE(PSOC4_MAX_SNS) - 1)
 
 #endif /* I2C_REG_MAP_H */
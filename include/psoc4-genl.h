@@ -0,0 +1,134 @@
+/* SPDX-License-Identifier: GPL-2.0 OR MIT */
+/*
+ * Copyright (C) 2025, Infineon Technologies AG, or an affiliate of Infineon Technologies AG.
+ * All rights reserved.
+ *
+ * Licensed under either of
+ *
+ * GNU General Public License, Version 2.0 <https://www.gnu.org/licenses/gpl-2.0.html>
+ * MIT license  <http://opensource.org/licenses/MIT>
+ *
+ * at your option.
+ *
+ * When Licensed under the GNU General Public License, Version 2.0 (the "License");
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/gpl-2.0.html>
+ *
+ * When licensed under the MIT license;
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the “Software”), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PSOC4_GENL_H
+#define PSOC4_GENL_H
+
+// Generic netlink interface of the driver, shared with user space.
+// Only plain definitions may be added here, the file is included by user
+// space programs as it is.
+
+#define PSOC4_GENL_NAME		"psoc4_capsense"
+#define PSOC4_GENL_VERSION	1
+
+// Multicast groups, "events" gets every frame, the others only the frames
+// with their INT_STATUS bit set
+#define PSOC4_GENL_MCGRP_EVENTS_NAME		"events"
+#define PSOC4_GENL_MCGRP_TOUCH_NAME		"touch"
+#define PSOC4_GENL_MCGRP_GESTURE_NAME		"gesture"
+#define PSOC4_GENL_MCGRP_LIFTOFF_TOUCHDOWN_NAME	"liftoff_tchdwn"
+#define PSOC4_GENL_MCGRP_SCAN_NAME		"scan_complete"
+#define PSOC4_GENL_MCGRP_TEST_NAME		"test_result"
+#define PSOC4_GENL_MCGRP_ERROR_NAME		"app_error"
+
+enum psoc4_genl_mcgrp {
+	PSOC4_GENL_MCGRP_EVENTS,
+	PSOC4_GENL_MCGRP_TOUCH,
+	PSOC4_GENL_MCGRP_GESTURE,
+	PSOC4_GENL_MCGRP_LIFTOFF_TOUCHDOWN,
+	PSOC4_GENL_MCGRP_SCAN,
+	PSOC4_GENL_MCGRP_TEST,
+	PSOC4_GENL_MCGRP_ERROR,
+	PSOC4_GENL_MCGRP_COUNT,
+};
+
+// Commands
+enum psoc4_genl_cmd {
+	PSOC4_CMD_UNSPEC,
+	PSOC4_CMD_EVENT,	// Kernel to user space: one interrupt frame
+	PSOC4_CMD_SET_CONFIG,	// Write configuration registers, replies with the status
+	PSOC4_CMD_GET_CONFIG,	// Read all configuration registers
+	__PSOC4_CMD_MAX,
+};
+#define PSOC4_CMD_MAX (__PSOC4_CMD_MAX - 1)
+
+// Attributes of the commands
+// Configuration requests select the device by PSOC4_ATTR_DEV_ID or PSOC4_ATTR_DEV_NAME.
+enum psoc4_genl_attr {
+	PSOC4_ATTR_UNSPEC,
+	PSOC4_ATTR_PAD,
+	PSOC4_ATTR_DEV_ID,	// u32: device number, unique while the device is bound
+	PSOC4_ATTR_DEV_NAME,	// string: I2C device name, e.g. "1-000d"
+	PSOC4_ATTR_SEQ,		// u32: per-device event sequence number
+	PSOC4_ATTR_TIMESTAMP,	// s64: CLOCK_MONOTONIC time of the interrupt in ns
+	PSOC4_ATTR_INT_STATUS,	// u8: INT_STATUS bits of the frame
+	PSOC4_ATTR_NUM_TOUCH,	// u8: number of touches, with INT_STATUS touch detected
+	PSOC4_ATTR_TOUCHES,	// nested: one PSOC4_ATTR_TOUCH per touch slot
+	PSOC4_ATTR_GESTURES,	// u32: gesture word, with INT_STATUS gesture detected
+	PSOC4_ATTR_CONFIG,	// nested: one PSOC4_ATTR_REG per configuration register
+	__PSOC4_ATTR_MAX,
+};
+#define PSOC4_ATTR_MAX (__PSOC4_ATTR_MAX - 1)
+
+// Type of the entries in PSOC4_ATTR_TOUCHES
+#define PSOC4_ATTR_TOUCH	1
+
+// Attributes of a PSOC4_ATTR_TOUCH entry
+enum psoc4_genl_touch_attr {
+	PSOC4_TOUCH_ATTR_UNSPEC,
+	PSOC4_TOUCH_ATTR_SLOT,	// u8: touch slot
+	PSOC4_TOUCH_ATTR_X,	// u16: X coordinate
+	PSOC4_TOUCH_ATTR_Y,	// u16: Y coordinate
+	PSOC4_TOUCH_ATTR_Z,	// u16: Z (signal strength)
+	__PSOC4_TOUCH_ATTR_MAX,
+};
+#define PSOC4_TOUCH_ATTR_MAX (__PSOC4_TOUCH_ATTR_MAX - 1)
+
+// Type of the entries in PSOC4_ATTR_CONFIG
+#define PSOC4_ATTR_REG		1
+
+// Attributes of a PSOC4_ATTR_REG entry
+enum psoc4_genl_reg_attr {
+	PSOC4_REG_ATTR_UNSPEC,
+	PSOC4_REG_ATTR_ADDR,	// u8: register address
+	PSOC4_REG_ATTR_VALUE,	// u8: register value
+	PSOC4_REG_ATTR_STATUS,	// s32: result of the write, 0 or a negative errno
+	__PSOC4_REG_ATTR_MAX,
+};
+#define PSOC4_REG_ATTR_MAX (__PSOC4_REG_ATTR_MAX - 1)
+
+#endif // PSOC4_GENL_H
@@ -49,12 +49,66 @@
 #define PSOC4_I2C_H
 
 #include <linux/i2c.h>
+#include <linux/regmap.h>
+#include <linux/atomic.h>
+
+#include "i2c-reg-map.h"
+
+struct psoc4_frame;
+
+// Transfer buffer: sub-address + largest register block (sensor data of all sensors)
+#define PSOC4_XFER_BUF_SIZE	(2 + REG_SNS_DATA_SIZE(PSOC4_MAX_SNS))
+
+/* Register cache statistics */
+struct psoc4_reg_cache_stats {
+	atomic_long_t hits;
+	atomic_long_t misses;
+};
+
+/* Limits of the retry policy
+ * The backoff and the deadline are spent sleeping with the device lock held.
+ */
+#define PSOC4_RETRY_MAX_RETRIES		20
+#define PSOC4_RETRY_MAX_DELAY_US	2000U	// Also the cap of the doubled backoff
+#define PSOC4_RETRY_MAX_DEADLINE_MS	100U
+
+/* Retry policy of I2C transfers */
+struct psoc4_retry_policy {
+	unsigned int max_retries;
+	unsigned int delay_us;		// Initial backoff, doubled on every retry
+	unsigned int deadline_ms;	// Time limit of a single transfer incl. retries
+};
+
+/* Failed I2C transfers per error class */
+struct psoc4_i2c_error_stats {
+	atomic_long_t nack;
+	atomic_long_t arb_lost;
+	atomic_long_t timeout;
+	atomic_long_t other;
+};
+
+/* Sensor data of one scan, read in a single transfer */
+struct psoc4_sns_snapshot {
+	u8 num_sns;
+	u16 raw[PSOC4_MAX_SNS];
+	u16 bsln[PSOC4_MAX_SNS];
+	u32 cp[PSOC4_MAX_SNS];
+	u8 regs[REG_SNS_DATA_SIZE(PSOC4_MAX_SNS)];	// Registers as read from the device
+};
 
 /* Function prototypes for PSOC4 I2C operations */
+void psoc4_retry_policy_init(struct psoc4_retry_policy *policy);
 int i2c_safe_transfer(struct i2c_client *client, struct i2c_msg *msgs, int num);
 int psoc4_read_register(struct i2c_client *client, u8 reg_address, u8 *buffer, int count);
 int psoc4_write_register(struct i2c_client *client, u8 reg_address, const u8 *data, int count);
+int psoc4_update_register(struct i2c_client *client, u8 reg_address, u8 mask, u8 value);
 int psoc4_read_xyz_coords(struct i2c_client *client, u8 reg, u16 *x, u16 *y, u16 *z);
 int psoc4_read_gestures(struct i2c_client *client, u32 *gestures);
+int psoc4_read_config(struct i2c_client *client, u8 *buffer);
+int psoc4_read_frame(struct i2c_client *client, struct psoc4_frame *frame);
+int psoc4_read_num_sns(struct i2c_client *client, u8 *num_sns);
+int psoc4_read_sns_snapshot(struct i2c_client *client, struct psoc4_sns_snapshot *snap);
+int psoc4_regmap_init(struct i2c_client *client);
+void psoc4_reg_cache_invalidate(struct i2c_client *client);
 
 #endif // PSOC4_I2C_H
@@ -0,0 +1,93 @@
+/* SPDX-License-Identifier: GPL-2.0 OR MIT */
+/*
+ * Copyright (C) 2025, Infineon Technologies AG, or an affiliate of Infineon Technologies AG.
+ * All rights reserved.
+ *
+ * Licensed under either of
+ *
+ * GNU General Public License, Version 2.0 <https://www.gnu.org/licenses/gpl-2.0.html>
+ * MIT license  <http://opensource.org/licenses/MIT>
+ *
+ * at your option.
+ *
+ * When Licensed under the GNU General Public License, Version 2.0 (the "License");
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/gpl-2.0.html>
+ *
+ * When licensed under the MIT license;
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the “Software”), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PSOC4_RING_H
+#define PSOC4_RING_H
+
+// Frame ring of the /dev/psoc4-N character device, shared with user space.
+// Only plain definitions may be added here, the file is included by user
+// space programs as it is.
+
+#include <linux/types.h>
+
+#define PSOC4_RING_VERSION	1
+#define PSOC4_RING_RECORDS	256	// Power of 2
+
+// Touch slot of a frame record
+struct psoc4_ring_touch {
+	__u16 x;
+	__u16 y;
+	__u16 z;
+	__u16 reserved;
+};
+
+// Frame record, read() returns whole records
+struct psoc4_ring_frame {
+	__s64 timestamp;	// CLOCK_MONOTONIC time of the interrupt in ns
+	__u32 seq;		// Record index, counts every frame written to the ring
+	__u32 gestures;		// Gesture word read with the frame
+	__u8 int_status;	// INT_STATUS bits of the frame
+	__u8 num_touches;	// Number of touches
+	__u16 reserved;
+	struct psoc4_ring_touch touches[2];
+	__u32 reserved2;
+};
+
+// Start of the read-only mapping, the records follow at data_offset
+// Record i is stored at index i % num_records. It is valid if head - i is
+// below num_records both before and after it was copied, otherwise the driver
+// has overwritten it. Indices wrap at 2^32. Load head with acquire ordering
+// and put an acquire fence between the copy and the second load of head.
+struct psoc4_ring_header {
+	__u32 version;		// PSOC4_RING_VERSION
+	__u32 record_size;	// sizeof(struct psoc4_ring_frame)
+	__u32 num_records;	// PSOC4_RING_RECORDS
+	__u32 data_offset;	// Offset of the first record in the mapping
+	__u32 head;		// Index of the next record, written by the driver
+};
+
+#endif // PSOC4_RING_H
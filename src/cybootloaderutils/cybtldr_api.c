@@ -50,9 +50,25 @@
 #define DFU_MAX_RETRY 10
 
 static struct CyBtldr_CommunicationsData *g_comm;
+static struct CyBtldr_Session *g_session;
 
 static u16 min_uint16(u16 a, u16 b) { return (a < b) ? a : b; }
 
+int CyBtldr_CreateSession(void)
+{
+	g_session = kmalloc(sizeof(*g_session), GFP_KERNEL);
+	if (!g_session)
+		return -ENOMEM;
+
+	return CYRET_SUCCESS;
+}
+
+void CyBtldr_DestroySession(void)
+{
+	kfree(g_session);
+	g_session = NULL;
+}
+
 int CyBtldr_TransferData(u8 *inBuf, int inSize, u8 *outBuf, int outSize)
 {
 	int err = g_comm->WriteData(inBuf, inSize);
@@ -88,15 +104,8 @@ int CyBtldr_StartBootloadOperation(struct CyBtldr_CommunicationsData *comm, u32
 	u8 status = CYRET_SUCCESS;
 	int err;
 
-	inBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!inBuf)
-		return -ENOMEM;
-
-	outBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!outBuf) {
-		kfree(inBuf);
-		return -ENOMEM;
-	}
+	inBuf = g_session->inBuf;
+	outBuf = g_session->outBuf;
 
 	g_comm = comm;
 
@@ -128,9 +137,6 @@ int CyBtldr_StartBootloadOperation(struct CyBtldr_CommunicationsData *comm, u32
 			err = CYRET_ERR_DEVICE;
 	}
 
-	kfree(inBuf);
-	kfree(outBuf);
-
 	return err;
 }
 
@@ -140,9 +146,7 @@ int CyBtldr_EndBootloadOperation(void)
 	u32 outSize;
 	u8 *inBuf;
 
-	inBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!inBuf)
-		return -ENOMEM;
+	inBuf = g_session->inBuf;
 
 	int err = CyBtldr_CreateExitBootLoaderCmd(inBuf, &inSize, &outSize);
 
@@ -157,8 +161,6 @@ int CyBtldr_EndBootloadOperation(void)
 	}
 	g_comm = NULL;
 
-	kfree(inBuf);
-
 	return err;
 }
 
@@ -255,15 +257,8 @@ int CyBtldr_ProgramRow(u32 address, u8 *buf, u16 size)
 	u8 status = CYRET_SUCCESS;
 	int err = CYRET_SUCCESS;
 
-	inBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!inBuf)
-		return -ENOMEM;
-
-	outBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!outBuf) {
-		kfree(inBuf);
-		return -ENOMEM;
-	}
+	inBuf = g_session->inBuf;
+	outBuf = g_session->outBuf;
 
 	u32 chksum = CyBtldr_ComputeChecksum32bit(buf, size);
 
@@ -286,9 +281,6 @@ int CyBtldr_ProgramRow(u32 address, u8 *buf, u16 size)
 			err = status | CYRET_ERR_BTLDR_MASK;
 	}
 
-	kfree(inBuf);
-	kfree(outBuf);
-
 	return err;
 }
 
@@ -301,15 +293,8 @@ int CyBtldr_EraseRow(u32 address)
 	u8 status = CYRET_SUCCESS;
 	int err = CYRET_SUCCESS;
 
-	inBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!inBuf)
-		return -ENOMEM;
-
-	outBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!outBuf) {
-		kfree(inBuf);
-		return -ENOMEM;
-	}
+	inBuf = g_session->inBuf;
+	outBuf = g_session->outBuf;
 
 
 	if (err == CYRET_SUCCESS) {
@@ -323,9 +308,6 @@ int CyBtldr_EraseRow(u32 address)
 	if (status != CYRET_SUCCESS)
 		err = status | CYRET_ERR_BTLDR_MASK;
 
-	kfree(inBuf);
-	kfree(outBuf);
-
 	return err;
 }
 
@@ -342,15 +324,8 @@ int CyBtldr_VerifyRow(u32 address, u8 *buf, u16 size)
 	u8 status = CYRET_SUCCESS;
 	int err = CYRET_SUCCESS;
 
-	inBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!inBuf)
-		return -ENOMEM;
-
-	outBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!outBuf) {
-		kfree(inBuf);
-		return -ENOMEM;
-	}
+	inBuf = g_session->inBuf;
+	outBuf = g_session->outBuf;
 
 	u32 chksum = CyBtldr_ComputeChecksum32bit(buf, size);
 
@@ -374,9 +349,6 @@ int CyBtldr_VerifyRow(u32 address, u8 *buf, u16 size)
 			err = status | CYRET_ERR_BTLDR_MASK;
 	}
 
-	kfree(inBuf);
-	kfree(outBuf);
-
 	return err;
 }
 
@@ -389,15 +361,8 @@ int CyBtldr_VerifyApplication(u8 appId)
 	u8 checksumValid = 0;
 	u8 status = CYRET_SUCCESS;
 
-	inBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!inBuf)
-		return -ENOMEM;
-
-	outBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!outBuf) {
-		kfree(inBuf);
-		return -ENOMEM;
-	}
+	inBuf = g_session->inBuf;
+	outBuf = g_session->outBuf;
 
 	int err = CyBtldr_CreateVerifyChecksumCmd(appId, inBuf, &inSize, &outSize);
 
@@ -413,9 +378,6 @@ int CyBtldr_VerifyApplication(u8 appId)
 	if ((err == CYRET_SUCCESS) && (!checksumValid))
 		err = CYRET_ERR_CHECKSUM;
 
-	kfree(inBuf);
-	kfree(outBuf);
-
 	return err;
 }
 
@@ -427,15 +389,8 @@ int CyBtldr_SetApplicationMetaData(u8 appId, u32 appStartAddr, u32 appSize)
 	u32 outSize = 0;
 	u8 status = CYRET_SUCCESS;
 
-	inBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!inBuf)
-		return -ENOMEM;
-
-	outBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!outBuf) {
-		kfree(inBuf);
-		return -ENOMEM;
-	}
+	inBuf = g_session->inBuf;
+	outBuf = g_session->outBuf;
 
 	u8 metadata[8];
 
@@ -460,9 +415,6 @@ int CyBtldr_SetApplicationMetaData(u8 appId, u32 appStartAddr, u32 appSize)
 	if (status != CYRET_SUCCESS)
 		err = status | CYRET_ERR_BTLDR_MASK;
 
-	kfree(inBuf);
-	kfree(outBuf);
-
 	return err;
 }
 
@@ -475,15 +427,8 @@ int CyBtldr_SetEncryptionInitialVector(u16 size, u8 *buf)
 	u32 outSize = 0;
 	u8 status = CYRET_SUCCESS;
 
-	inBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!inBuf)
-		return -ENOMEM;
-
-	outBuf = kmalloc(MAX_COMMAND_SIZE, GFP_KERNEL);
-	if (!outBuf) {
-		kfree(inBuf);
-		return -ENOMEM;
-	}
+	inBuf = g_session->inBuf;
+	outBuf = g_session->outBuf;
 
 	int err = CyBtldr_CreateSetEncryptionInitialVectorCmd(buf, size, inBuf, &inSize, &outSize);
 
@@ -495,8 +440,5 @@ int CyBtldr_SetEncryptionInitialVector(u16 size, u8 *buf)
 	if (status != CYRET_SUCCESS)
 		err = status | CYRET_ERR_BTLDR_MASK;
 
-	kfree(inBuf);
-	kfree(outBuf);
-
 	return err;
 }
@@ -42,165 +42,92 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#include <linux/string.h>
 #include "cybootloaderutils/cybtldr_api.h"
 #include "cybootloaderutils/cybtldr_api2.h"
 
 u8 g_abort;
 
-static int ProcessDataRow(enum CyBtldr_Action action, u32 rowSize, char *rowData,
-	CyBtldr_ProgressUpdate *update, u32 applicationStartAddr, u32 applicationDataLines,
-	u32 *applicationDataLinesSeen)
+static int ProcessRow(enum CyBtldr_Action action, const struct CyBtldr_Row *row)
 {
-	u8 buffer[MAX_BUFFER_SIZE];
-	u16 bufSize;
-	u32 address;
-	u8 checksum;
-
-	int err = CyBtldr_ParseCyAcd2RowData(rowSize, rowData, &address,
-			buffer, &bufSize, &checksum);
-
-	if (err == CYRET_SUCCESS) {
-		switch (action) {
-		case ERASE:
-			err = CyBtldr_EraseRow(address);
-			break;
-		case PROGRAM:
-			err = CyBtldr_ProgramRow(address, buffer, bufSize);
-			break;
-		case VERIFY:
-			err = CyBtldr_VerifyRow(address, buffer, bufSize);
-			break;
-		}
-	}
-
-	return err;
-}
-
-static int ProcessMetaRow(u32 rowSize, char *rowData)
-{
-	const u32 EIV_META_HEADER_SIZE = 5;
-	static const char EIV_META_HEADER[] = "@EIV:";
-
-	u8 buffer[MAX_BUFFER_SIZE];
-	u16 bufSize = 0;
-
+	/* The row commands take a non-const buffer but never modify it */
+	u8 *data = (u8 *)row->data;
 	int err = CYRET_SUCCESS;
 
-	if (rowSize >= EIV_META_HEADER_SIZE &&
-		strncmp(rowData, EIV_META_HEADER, EIV_META_HEADER_SIZE) == 0) {
-		err = CyBtldr_FromAscii(rowSize - EIV_META_HEADER_SIZE,
-			rowData + EIV_META_HEADER_SIZE, &bufSize, buffer);
-		if (err == CYRET_SUCCESS)
-			err = CyBtldr_SetEncryptionInitialVector(bufSize, buffer);
+	if (row->type == CYBTLDR_ROW_EIV)
+		return CyBtldr_SetEncryptionInitialVector(row->size, data);
+
+	switch (action) {
+	case ERASE:
+		err = CyBtldr_EraseRow(row->address);
+		break;
+	case PROGRAM:
+		err = CyBtldr_ProgramRow(row->address, data, row->size);
+		break;
+	case VERIFY:
+		err = CyBtldr_VerifyRow(row->address, data, row->size);
+		break;
 	}
+
 	return err;
 }
 
 int CyBtldr_RunAction(enum CyBtldr_Action action, struct CyBtldr_CommunicationsData *comm,
-		CyBtldr_ProgressUpdate *update, const char *file)
+		CyBtldr_ProgressUpdate *update, const struct CyBtldr_Image *image)
 {
 	g_abort = 0;
-	u32 lineLen;
-	char line[MAX_BUFFER_SIZE * 2];  // 2 hex characters per byte
-	u8 fileVersion = 0;
-
-	int err = CyBtldr_OpenDataFile(file);
-
-	if (err == CYRET_SUCCESS) {
-		err = CyBtldr_ReadLine(&lineLen, line);
-		// the following functions checks
-		if (err == CYRET_SUCCESS)
-			err = CyBtldr_CheckCyacdFileVersion(lineLen, line, &fileVersion);
-
-		if (err == CYRET_SUCCESS) {
-			u32 blVer = 0;
-			u32 siliconId = 0;
-			u8 siliconRev = 0;
-			u8 chksumtype = SUM_CHECKSUM;
-			u8 appId = 0;
-			u8 bootloaderEntered = 0;
-			u32 applicationStartAddr = 0xffffffff;
-			u32 applicationSize = 0;
-			u32 applicationDataLines = 255;
-			u32 applicationDataLinesSeen = 0;
-			u64 productId = 0;
-
-			err = CyBtldr_ParseHeader(lineLen, line, &siliconId, &siliconRev,
-				&chksumtype, &appId, &productId);
-
-			if (err == CYRET_SUCCESS) {
-				CyBtldr_SetCheckSumType(chksumtype);
-
-				// send ENTER DFU command to start communication
-				err = CyBtldr_StartBootloadOperation(comm, siliconId,
-					siliconRev, &blVer, productId);
-
-				// send Set Application Metadata command
-				if (err == CYRET_SUCCESS)
-					err = CyBtldr_ParseCyAcdAppStartAndSize(
-						&applicationStartAddr, &applicationSize,
-						&applicationDataLines, line);
-				if (err == CYRET_SUCCESS)
-					err = CyBtldr_SetApplicationMetaData(appId,
-						applicationStartAddr, applicationSize);
-				bootloaderEntered = 1;
-			}
-
-
-			while (err == CYRET_SUCCESS) {
-				if (g_abort) {
-					g_abort = 0;
-					err = CYRET_ABORT;
-					break;
-				}
-
-				err = CyBtldr_ReadLine(&lineLen, line);
-				if (err == CYRET_SUCCESS) {
-					switch (line[0]) {
-					case '@':
-						err = ProcessMetaRow(lineLen, line);
-						break;
-					case ':':
-						err = ProcessDataRow(action, lineLen, line, update,
-							applicationStartAddr, applicationDataLines,
-							&applicationDataLinesSeen);
-						break;
-					}
-				} else if (err == CYRET_ERR_EOF) {
-					err = CYRET_SUCCESS;
-					break;
-				}
-			}
-			if (err == CYRET_SUCCESS && (action == PROGRAM || action == VERIFY)) {
-				err = CyBtldr_VerifyApplication(appId);
-				CyBtldr_EndBootloadOperation();
-			} else if (CYRET_ERR_COMM_MASK != (CYRET_ERR_COMM_MASK & err) &&
-						bootloaderEntered) {
-				CyBtldr_EndBootloadOperation();
-			}
+	u32 blVer = 0;
+	u32 i;
+	u8 bootloaderEntered = 0;
+	int err;
+
+	CyBtldr_SetCheckSumType(image->chksumType);
+
+	// send ENTER DFU command to start communication
+	err = CyBtldr_StartBootloadOperation(comm, image->siliconId,
+		image->siliconRev, &blVer, image->productId);
+
+	// send Set Application Metadata command
+	if (err == CYRET_SUCCESS)
+		err = CyBtldr_SetApplicationMetaData(image->appId,
+			image->appStart, image->appSize);
+	bootloaderEntered = 1;
+
+	for (i = 0; err == CYRET_SUCCESS && i < image->numRows; i++) {
+		if (g_abort) {
+			g_abort = 0;
+			err = CYRET_ABORT;
+			break;
 		}
-		CyBtldr_CloseDataFile();
+
+		err = ProcessRow(action, &image->rows[i]);
+	}
+
+	if (err == CYRET_SUCCESS && (action == PROGRAM || action == VERIFY)) {
+		err = CyBtldr_VerifyApplication(image->appId);
+		CyBtldr_EndBootloadOperation();
+	} else if (CYRET_ERR_COMM_MASK != (CYRET_ERR_COMM_MASK & err) &&
+				bootloaderEntered) {
+		CyBtldr_EndBootloadOperation();
 	}
 	return err;
 }
 
-int CyBtldr_Program(const char *file, struct CyBtldr_CommunicationsData *comm,
+int CyBtldr_Program(const struct CyBtldr_Image *image, struct CyBtldr_CommunicationsData *comm,
 				CyBtldr_ProgressUpdate *update)
 {
-	return CyBtldr_RunAction(PROGRAM, comm, update, file);
+	return CyBtldr_RunAction(PROGRAM, comm, update, image);
 }
 
-int CyBtldr_Erase(const char *file, struct CyBtldr_CommunicationsData *comm,
+int CyBtldr_Erase(const struct CyBtldr_Image *image, struct CyBtldr_CommunicationsData *comm,
 				CyBtldr_ProgressUpdate *update)
 {
-	return CyBtldr_RunAction(ERASE, comm, update, file);
+	return CyBtldr_RunAction(ERASE, comm, update, image);
 }
 
-int CyBtldr_Verify(const char *file, struct CyBtldr_CommunicationsData *comm,
+int CyBtldr_Verify(const struct CyBtldr_Image *image, struct CyBtldr_CommunicationsData *comm,
 				CyBtldr_ProgressUpdate *update)
 {
-	return CyBtldr_RunAction(VERIFY, comm, update, file);
+	return CyBtldr_RunAction(VERIFY, comm, update, image);
 }
 
 int CyBtldr_Abort(void)
@@ -44,134 +44,63 @@
 
 #include "cybootloaderutils/cybtldr_parse.h"
 #include <linux/string.h>
-#include <linux/fs.h>
 #include <linux/err.h>
 #include <linux/slab.h>
-#include <linux/uio.h>
 
-/* Pointer to the *.cyacd file containing the data that is to be read */
-static struct file *dataFile;
-
-static u16 parse2ByteValueLittleEndian(u8 *buf)
+static u16 parse2ByteValueLittleEndian(const u8 *buf)
 {
 	return ((u16)buf[0]) | (((u16)buf[1]) << 8);
 }
 
-static u32 parse4ByteValueLittleEndian(u8 *buf)
+static u32 parse4ByteValueLittleEndian(const u8 *buf)
 {
 	return ((u32)parse2ByteValueLittleEndian(buf)) |
 			(((u32)parse2ByteValueLittleEndian(buf + 2)) << 16);
 }
 
+/* Value of every hexadecimal digit, CYBTLDR_HEX_INVALID for all other chars */
+static const u8 hexTable[256] = {
+	[0x00 ... '0' - 1] = CYBTLDR_HEX_INVALID,
+	['0'] = 0x0, ['1'] = 0x1, ['2'] = 0x2, ['3'] = 0x3, ['4'] = 0x4,
+	['5'] = 0x5, ['6'] = 0x6, ['7'] = 0x7, ['8'] = 0x8, ['9'] = 0x9,
+	['9' + 1 ... 'A' - 1] = CYBTLDR_HEX_INVALID,
+	['A'] = 0xA, ['B'] = 0xB, ['C'] = 0xC, ['D'] = 0xD, ['E'] = 0xE, ['F'] = 0xF,
+	['F' + 1 ... 'a' - 1] = CYBTLDR_HEX_INVALID,
+	['a'] = 0xA, ['b'] = 0xB, ['c'] = 0xC, ['d'] = 0xD, ['e'] = 0xE, ['f'] = 0xF,
+	['f' + 1 ... 0xFF] = CYBTLDR_HEX_INVALID,
+};
+
 u8 CyBtldr_FromHex(char value)
 {
-	if ('0' <= value && value <= '9')
-		return (u8)(value - '0');
-
-	if ('a' <= value && value <= 'f')
-		return (u8)(10 + value - 'a');
-
-	if ('A' <= value && value <= 'F')
-		return (u8)(10 + value - 'A');
-
-	return 0;
+	return hexTable[(u8)value];
 }
 
-int CyBtldr_FromAscii(u32 bufSize, char *buffer, u16 *rowSize, u8 *rowData)
+int CyBtldr_FromAscii(u32 bufSize, const char *buffer, u16 *rowSize, u8 *rowData)
 {
+	const u8 *ascii = (const u8 *)buffer;
+	u8 invalid = 0;
+	u8 hi, lo;
 	u16 i;
-	int err = CYRET_SUCCESS;
 
 	if (bufSize & 1)  // Make sure even number of bytes
-		err = CYRET_ERR_LENGTH;
-	else {
-		for (i = 0; i < bufSize / 2; i++)
-			rowData[i] = (CyBtldr_FromHex(buffer[i * 2]) << 4) |
-						CyBtldr_FromHex(buffer[i * 2 + 1]);
-		*rowSize = i;
-	}
-
-	return err;
-}
-
-static int CyBtldr_FileGetString(struct file *file, char *buffer, size_t size)
-{
-	char ch;
-	ssize_t bytes_read;
-	int count = 0;
-
-	if (!file || !buffer || size == 0)
-		return -1;
-
-	while (count < size) {
-		bytes_read = kernel_read(file, &ch, 1, &file->f_pos);
-
-		if (bytes_read < 0)
-			return bytes_read; // Reading error
-
-		if (bytes_read == 0) {
-			// EOF reached
-			if (count == 0)
-				return 0; // Empty line at EOF
-			break;
-		}
-
-		buffer[count++] = ch;
-
-		if (ch == '\n')
-			break; // End of line
+		return CYRET_ERR_LENGTH;
+
+	// Invalid digits have the upper bits set, so one check covers the row
+	for (i = 0; i < bufSize / 2; i++) {
+		hi = hexTable[ascii[i * 2]];
+		lo = hexTable[ascii[i * 2 + 1]];
+		invalid |= hi | lo;
+		rowData[i] = (hi << 4) | lo;
 	}
 
-	buffer[count] = '\0'; // Null-terminate the string
-
-	return count; // Return number of characters read
-}
-
-int CyBtldr_ReadLine(u32 *size, char *buffer)
-{
-	int err = CYRET_SUCCESS;
-	u32 len;
-	ssize_t bytes_read;
-
-	/* line that start with '#' are assumed to be comments
-	 * continue reading if we read a comment
-	 */
-	do {
-		len = 0;
-		if (dataFile != NULL) {
-			bytes_read = CyBtldr_FileGetString(dataFile, buffer, MAX_BUFFER_SIZE * 2);
-
-			if (bytes_read > 0) {
-				// Remove trailing newline characters
-				len = (u32) strlen(buffer);
-				while (len > 0 && ('\n' == buffer[len - 1] ||
-						'\r' == buffer[len - 1]))
-					--len;
-			} else if (bytes_read == 0) {
-				err = CYRET_ERR_EOF;
-			} else {
-				err = CYRET_ERR_FILE;
-			}
-		} else
-			err = CYRET_ERR_FILE;
-	} while (err == CYRET_SUCCESS && buffer[0] == '#');
-
-	*size = len;
-	return err;
-}
-
-int CyBtldr_OpenDataFile(const char *file)
-{
-	dataFile = filp_open(file, O_RDONLY, 0);
-	if (IS_ERR(dataFile)) {
-		pr_err("Failed to open data file: %ld\n", PTR_ERR(dataFile));
-		return CYRET_ERR_FILE;
-	}
+	if (invalid & ~0xF)
+		return CYRET_ERR_DATA;
 
+	*rowSize = i;
 	return CYRET_SUCCESS;
 }
 
-int CyBtldr_CheckCyacdFileVersion(u32 bufSize, char *header, u8 *version)
+int CyBtldr_CheckCyacdFileVersion(u32 bufSize, const char *header, u8 *version)
 {
 	// check file extension of the file, if extension is cyacd, version 0
 	int err = CYRET_SUCCESS;
@@ -183,158 +112,257 @@ int CyBtldr_CheckCyacdFileVersion(u32 bufSize, char *header, u8 *version)
 		err = CYRET_ERR_FILE;
 	// .cyacd2 file stores version information in the first byte of the file header.
 	if (err == CYRET_SUCCESS) {
-		*version = CyBtldr_FromHex(header[0]) << 4 | CyBtldr_FromHex(header[1]);
-		if (*version != 1)
+		u16 size;
+
+		if (CyBtldr_FromAscii(2, header, &size, version) != CYRET_SUCCESS ||
+				*version != 1)
 			err = CYRET_ERR_DATA;
 	}
 
 	return err;
 }
 
-int CyBtldr_ParseHeader(u32 bufSize, char *buffer, u32 *siliconId, u8 *siliconRev,
+int CyBtldr_ParseHeader(u32 bufSize, const char *buffer, u32 *siliconId, u8 *siliconRev,
 			u8 *chksum, u8 *appID, u64 *productID)
 {
+	const u16 HEADER_SIZE = 12;
 	int err = CYRET_SUCCESS;
 	u16 rowSize = 0;
-	u8 rowData[MAX_BUFFER_SIZE];
+	u8 rowData[12];
+
+	// Only a header of the exact size is decoded
+	if (bufSize != HEADER_SIZE * 2)
+		err = CYRET_ERR_LENGTH;
 
 	if (err == CYRET_SUCCESS)
 		err = CyBtldr_FromAscii(bufSize, buffer, &rowSize, rowData);
 
 	if (err == CYRET_SUCCESS) {
-		if (rowSize == 12) {
-			*siliconId = parse4ByteValueLittleEndian(rowData + 1);
-			*siliconRev = rowData[5];
-			*chksum = rowData[6];
-			*appID = rowData[7];
-			*productID = parse4ByteValueLittleEndian(rowData + 8);
-		} else {
-			err = CYRET_ERR_LENGTH;
-		}
+		*siliconId = parse4ByteValueLittleEndian(rowData + 1);
+		*siliconRev = rowData[5];
+		*chksum = rowData[6];
+		*appID = rowData[7];
+		*productID = parse4ByteValueLittleEndian(rowData + 8);
 	}
 	return err;
 }
 
-int CyBtldr_ParseCyAcd2RowData(u32 bufSize, char *buffer, u32 *address,
-			u8 *rowData, u16 *size, u8 *checksum)
+/* Returns the next line of the image, without its line ending */
+static bool CyBtldr_NextLine(const u8 *image, u32 size, u32 *pos, const char **line, u32 *len)
 {
-	const u16 MIN_SIZE = 4;  // 4-addr
-	const int DATA_OFFSET = 4;
+	const u8 *start = image + *pos;
+	u32 remaining = size - *pos;
+	const u8 *eol;
+
+	if (remaining == 0)
+		return false;
+
+	eol = memchr(start, '\n', remaining);
+	*len = eol ? (u32)(eol - start) : remaining;
+	*pos += eol ? *len + 1 : *len;
+
+	while (*len > 0 && start[*len - 1] == '\r')
+		--(*len);
+	*line = (const char *)start;
+
+	return true;
+}
+
+/* Appends an empty row to the image, growing the row array as needed */
+static struct CyBtldr_Row *CyBtldr_AddRow(struct CyBtldr_Image *image, u32 *capacity)
+{
+	struct CyBtldr_Row *rows;
+
+	if (image->numRows == *capacity) {
+		rows = krealloc_array(image->rows, *capacity ? *capacity * 2 : 64,
+							sizeof(*rows), GFP_KERNEL);
+		if (!rows)
+			return NULL;
+		image->rows = rows;
+		*capacity = *capacity ? *capacity * 2 : 64;
+	}
+
+	return &image->rows[image->numRows++];
+}
 
-	unsigned int i;
+/* Decodes a ':' data row into the data area of the image */
+static int CyBtldr_ParseDataRow(u32 bufSize, const char *buffer, struct CyBtldr_Row *row,
+								u8 **data)
+{
+	const u16 MIN_SIZE = 4;  // 4-addr
 	u16 hexSize;
-	u8 hexData[MAX_BUFFER_SIZE];
-	int err = CYRET_SUCCESS;
+	u16 i;
+	int err;
 
 	if (bufSize <= MIN_SIZE)
-		err = CYRET_ERR_LENGTH;
-	else if (buffer[0] == ':') {
-		err = CyBtldr_FromAscii(bufSize - 1, &buffer[1], &hexSize, hexData);
-
-		if (err == CYRET_SUCCESS) {
-			*address = parse4ByteValueLittleEndian(hexData);
-			*checksum = 0;
-
-			if (hexSize > MIN_SIZE) {
-				*size = hexSize - MIN_SIZE;
-				for (i = 0; i < *size; i++) {
-					rowData[i] = (hexData[DATA_OFFSET + i]);
-					*checksum += rowData[i];
-				}
-			} else
-				err = CYRET_ERR_DATA;
-		}
-	} else
-		err = CYRET_ERR_CMD;
+		return CYRET_ERR_LENGTH;
+
+	err = CyBtldr_FromAscii(bufSize - 1, &buffer[1], &hexSize, *data);
+	if (err != CYRET_SUCCESS)
+		return err;
+	if (hexSize <= MIN_SIZE)
+		return CYRET_ERR_DATA;
+
+	row->type = CYBTLDR_ROW_DATA;
+	row->address = parse4ByteValueLittleEndian(*data);
+	row->data = *data + MIN_SIZE;
+	row->size = hexSize - MIN_SIZE;
+	row->checksum = 0;
+	for (i = 0; i < row->size; i++)
+		row->checksum += row->data[i];
+
+	*data += hexSize;
+	return CYRET_SUCCESS;
+}
 
-	return err;
+/* Parses the application start address and size of an @APPINFO row */
+static int CyBtldr_ParseAppInfo(u32 bufSize, const char *buffer, u32 *appStart, u32 *appSize)
+{
+	const u32 APPINFO_META_HEADER_SIZE = 11;
+	const u32 APPINFO_META_SEPARATOR_SIZE = 3;
+	static const char APPINFO_META_SEPARATOR[] = ",0x";
+	const char *separator;
+	u32 separatorIndex;
+	u32 i;
+	u8 digit;
+
+	separator = memchr(buffer, ',', bufSize);
+	if (!separator)
+		return CYRET_ERR_FILE;
+
+	separatorIndex = (u32)(separator - buffer);
+	if (bufSize - separatorIndex < APPINFO_META_SEPARATOR_SIZE ||
+			strncmp(separator, APPINFO_META_SEPARATOR, APPINFO_META_SEPARATOR_SIZE) != 0)
+		return CYRET_ERR_FILE;
+
+	*appStart = 0;
+	*appSize = 0;
+	for (i = APPINFO_META_HEADER_SIZE; i < separatorIndex; i++) {
+		digit = CyBtldr_FromHex(buffer[i]);
+		if (digit == CYBTLDR_HEX_INVALID)
+			return CYRET_ERR_DATA;
+		*appStart = (*appStart << 4) | digit;
+	}
+	for (i = separatorIndex + APPINFO_META_SEPARATOR_SIZE; i < bufSize; i++) {
+		digit = CyBtldr_FromHex(buffer[i]);
+		if (digit == CYBTLDR_HEX_INVALID)
+			return CYRET_ERR_DATA;
+		*appSize = (*appSize << 4) | digit;
+	}
+
+	return CYRET_SUCCESS;
 }
 
-int CyBtldr_ParseCyAcdAppStartAndSize(u32 *appStart, u32 *appSize, u32 *dataLines, char *buf)
+int CyBtldr_ParseImage(const u8 *buf, u32 size, struct CyBtldr_Image **image)
 {
 	const u32 APPINFO_META_HEADER_SIZE = 11;
 	static const char APPINFO_META_HEADER[] = "@APPINFO:0x";
 	const u32 EIV_META_HEADER_SIZE = 5;
 	static const char EIV_META_HEADER[] = "@EIV:";
-	const u32 APPINFO_META_SEPARATOR_SIZE = 3;
-	static const char APPINFO_META_SEPARATOR[] = ",0x";
-	static const char APPINFO_META_SEPARATOR_START[] = ",";
 
-	long fp = dataFile->f_pos; // Save current position in the file
-	*appStart = 0xffffffff;
-	*appSize = 0;
-	*dataLines = 0;
-	u32 addr = 0;
-	u32 rowLength;
-	u16 rowSize;
-	u32 separatorIndex;
-	u8 rowData[MAX_BUFFER_SIZE];
-	u8 checksum;
-	int err = CYRET_SUCCESS;
-	u32 i;
+	struct CyBtldr_Image *img;
+	struct CyBtldr_Row *row;
+	const char *line;
+	u32 pos = 0;
+	u32 len;
+	u32 capacity = 0;
+	u32 appStart = 0xffffffff;
+	u32 appSize = 0;
+	u8 *data;
+	u8 version;
+	bool headerFound = false;
 	bool appInfoFound = false;
+	int err = CYRET_SUCCESS;
+
+	*image = NULL;
+	if (!buf || size == 0)
+		return CYRET_ERR_FILE;
+
+	img = kzalloc(sizeof(*img), GFP_KERNEL);
+	if (!img)
+		return CYRET_ERR_FILE;
+
+	// Two hex characters per byte, the decoded rows never exceed half the image
+	img->data = kvmalloc(size / 2 + 1, GFP_KERNEL);
+	if (!img->data) {
+		kfree(img);
+		return CYRET_ERR_FILE;
+	}
+	data = img->data;
 
-	do {
-		err = CyBtldr_ReadLine(&rowLength, buf);
-		if (err == CYRET_SUCCESS) {
-			if (buf[0] == ':') {
-				if (!appInfoFound) {
-					err = CyBtldr_ParseCyAcd2RowData(rowLength, buf, &addr,
-						rowData, &rowSize, &checksum);
-
-					if (addr < (*appStart))
-						*appStart = addr;
-
-					(*appSize) += rowSize;
-				}
-				++(*dataLines);
-			} else if (rowLength >= APPINFO_META_HEADER_SIZE &&
-					strncmp(buf, APPINFO_META_HEADER,
-							APPINFO_META_HEADER_SIZE) == 0) {
-				// find separator index
-				separatorIndex = (u32)strcspn(buf, APPINFO_META_SEPARATOR_START);
-				if (strncmp(buf + separatorIndex,
-							APPINFO_META_SEPARATOR,
-							APPINFO_META_SEPARATOR_SIZE) == 0) {
-					*appStart = 0;
-					*appSize = 0;
-					for (i = APPINFO_META_HEADER_SIZE;
-							i < separatorIndex; i++) {
-						*appStart <<= 4;
-						*appStart += CyBtldr_FromHex(buf[i]);
-					}
-					for (i = separatorIndex + APPINFO_META_SEPARATOR_SIZE;
-							i < rowLength; i++) {
-						*appSize <<= 4;
-						*appSize += CyBtldr_FromHex(buf[i]);
-					}
-				} else {
-					err = CYRET_ERR_FILE;
-				}
-				appInfoFound = true;
-			} else if (strncmp(buf, EIV_META_HEADER, EIV_META_HEADER_SIZE) != 0) {
+	while (err == CYRET_SUCCESS && CyBtldr_NextLine(buf, size, &pos, &line, &len)) {
+		/* line that start with '#' are assumed to be comments */
+		if (len == 0 || line[0] == '#')
+			continue;
+
+		if (len > MAX_BUFFER_SIZE * 2) {
+			err = CYRET_ERR_LENGTH;
+		} else if (!headerFound) {
+			err = CyBtldr_CheckCyacdFileVersion(len, line, &version);
+			if (err == CYRET_SUCCESS)
+				err = CyBtldr_ParseHeader(len, line, &img->siliconId,
+						&img->siliconRev, &img->chksumType, &img->appId,
+						&img->productId);
+			headerFound = true;
+		} else if (line[0] == ':') {
+			row = CyBtldr_AddRow(img, &capacity);
+			if (!row) {
 				err = CYRET_ERR_FILE;
+				break;
 			}
-		}
-	} while (err == CYRET_SUCCESS);
-	if (err == CYRET_ERR_EOF)
-		err = CYRET_SUCCESS;
-	// reset to the file to where we were
-	if (err == CYRET_SUCCESS) {
-		if (default_llseek(dataFile, fp, SEEK_SET) < 0) {
-		// shouldn't be possible, we're just going to somewhere that was valid before
-			err = CYRET_ERR_EOF;
+			err = CyBtldr_ParseDataRow(len, line, row, &data);
+			if (err == CYRET_SUCCESS) {
+				if (row->address < appStart)
+					appStart = row->address;
+				appSize += row->size;
+			}
+		} else if (len >= APPINFO_META_HEADER_SIZE &&
+				strncmp(line, APPINFO_META_HEADER, APPINFO_META_HEADER_SIZE) == 0) {
+			err = CyBtldr_ParseAppInfo(len, line, &img->appStart, &img->appSize);
+			appInfoFound = true;
+		} else if (len >= EIV_META_HEADER_SIZE &&
+				strncmp(line, EIV_META_HEADER, EIV_META_HEADER_SIZE) == 0) {
+			row = CyBtldr_AddRow(img, &capacity);
+			if (!row) {
+				err = CYRET_ERR_FILE;
+				break;
+			}
+			row->type = CYBTLDR_ROW_EIV;
+			row->size = 0;
+			row->data = data;
+			err = CyBtldr_FromAscii(len - EIV_META_HEADER_SIZE,
+					line + EIV_META_HEADER_SIZE, &row->size, data);
+			data += row->size;
+		} else {
+			/* unknown or corrupted line, reject the image before it is flashed */
+			err = CYRET_ERR_FILE;
 		}
 	}
 
-	return err;
-}
+	if (err == CYRET_SUCCESS && !headerFound)
+		err = CYRET_ERR_EOF;
 
-int CyBtldr_CloseDataFile(void)
-{
-	if (dataFile) {
-		filp_close(dataFile, NULL);
-		dataFile = NULL;
+	if (err != CYRET_SUCCESS) {
+		CyBtldr_FreeImage(img);
+		return err;
 	}
+
+	// Without @APPINFO the application spans all data rows
+	if (!appInfoFound) {
+		img->appStart = appStart;
+		img->appSize = appSize;
+	}
+
+	*image = img;
 	return CYRET_SUCCESS;
 }
+
+void CyBtldr_FreeImage(struct CyBtldr_Image *image)
+{
+	if (!image)
+		return;
+
+	kfree(image->rows);
+	kvfree(image->data);
+	kfree(image);
+}
@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: GPL-2.0 OR MIT
+/*
+ * Copyright (C) 2025, Infineon Technologies AG, or an affiliate of Infineon Technologies AG.
+ * All rights reserved.
+ *
+ * Licensed under either of
+ *
+ * GNU General Public License, Version 2.0 <https://www.gnu.org/licenses/gpl-2.0.html>
+ * MIT license  <http://opensource.org/licenses/MIT>
+ *
+ * at your option.
+ *
+ * When Licensed under the GNU General Public License, Version 2.0 (the "License");
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/gpl-2.0.html>
+ *
+ * When licensed under the MIT license;
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the “Software”), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "i2c-psoc4-driver.h"
+
+// Serializes attaching and detaching captures, also against device removal
+static DEFINE_MUTEX(psoc4_capture_lock);
+
+// Sensor capture session, owned by the open sns_stream file
+struct psoc4_capture {
+	struct psoc4_data *data;	// NULL once detached from the device
+	wait_queue_head_t wait;
+	struct mutex read_lock;		// Serializes read() calls
+	struct kfifo fifo;		// Scan records, written by the IRQ thread
+	size_t record_size;
+	u32 seq;			// Sequence number of the next scan
+	u8 *record;			// Record of the current scan
+};
+
+// Append the sensor data of a completed scan to the capture stream
+// Called with the event lock held
+void psoc4_capture_scan(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_capture *capture = data->capture;
+	struct psoc4_capture_record *header;
+	int ret;
+
+	if (!capture)
+		return;
+
+	header = (struct psoc4_capture_record *)capture->record;
+
+	// Raw counts and baselines are adjacent, both are read in one transfer
+	ret = psoc4_read_register(client, REG_SNS_RAW, capture->record + sizeof(*header),
+				REG_SNS_RAW_SIZE(header->num_sns) + REG_SNS_BSLN_SIZE(header->num_sns));
+	if (ret < 0) {
+		dev_err_ratelimited(&client->dev, "Failed to read sensor data: %d\n", ret);
+		return;
+	}
+
+	header->timestamp = ktime_to_ns(data->event_time);
+	header->seq = capture->seq++;
+
+	// A full fifo drops the scan, the reader sees a gap in the sequence
+	if (kfifo_avail(&capture->fifo) < capture->record_size)
+		return;
+
+	kfifo_in(&capture->fifo, capture->record, capture->record_size);
+	if (wq_has_sleeper(&capture->wait))
+		wake_up_interruptible(&capture->wait);
+}
+
+static void psoc4_capture_free(struct psoc4_capture *capture)
+{
+	kfifo_free(&capture->fifo);
+	kfree(capture->record);
+	kfree(capture);
+}
+
+// Stop capturing and restore the scan complete interrupt source
+// Called with the capture lock held
+static void psoc4_capture_detach(struct psoc4_capture *capture)
+{
+	struct psoc4_data *data = capture->data;
+
+	if (!data)
+		return;
+
+	mutex_lock(&data->event_lock);
+	data->capture = NULL;
+	mutex_unlock(&data->event_lock);
+
+	psoc4_scan_irq_put(data->client);
+
+	// Readers see end of file once the fifo is empty
+	WRITE_ONCE(capture->data, NULL);
+	wake_up_interruptible(&capture->wait);
+}
+
+// Attach a capture to the device and enable the scan complete interrupt
+static int psoc4_capture_open(struct inode *inode, struct file *file)
+{
+	struct i2c_client *client = inode->i_private;
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_capture_record *header;
+	struct psoc4_capture *capture;
+	u8 num_sns;
+	int ret;
+
+	ret = psoc4_read_num_sns(client, &num_sns);
+	if (ret < 0)
+		return ret;
+	if (num_sns == 0)
+		return -ENODEV;
+
+	capture = kzalloc(sizeof(*capture), GFP_KERNEL);
+	if (!capture)
+		return -ENOMEM;
+
+	capture->record_size = sizeof(*header) + REG_SNS_RAW_SIZE(num_sns) +
+							REG_SNS_BSLN_SIZE(num_sns);
+	capture->record = kzalloc(capture->record_size, GFP_KERNEL);
+	if (!capture->record || kfifo_alloc(&capture->fifo, CAPTURE_FIFO_SIZE, GFP_KERNEL)) {
+		kfree(capture->record);
+		kfree(capture);
+		return -ENOMEM;
+	}
+
+	header = (struct psoc4_capture_record *)capture->record;
+	header->num_sns = num_sns;
+	header->version = PSOC4_CAPTURE_VERSION;
+	init_waitqueue_head(&capture->wait);
+	mutex_init(&capture->read_lock);
+
+	mutex_lock(&psoc4_capture_lock);
+
+	// One capture per device
+	if (data->capture) {
+		ret = -EBUSY;
+		goto unlock;
+	}
+
+	ret = psoc4_scan_irq_get(client);
+	if (ret < 0)
+		goto unlock;
+
+	capture->data = data;
+	mutex_lock(&data->event_lock);
+	data->capture = capture;
+	mutex_unlock(&data->event_lock);
+
+unlock:
+	mutex_unlock(&psoc4_capture_lock);
+	if (ret < 0) {
+		psoc4_capture_free(capture);
+		return ret;
+	}
+
+	dev_dbg(&client->dev, "Capturing %u sensors\n", num_sns);
+	file->private_data = capture;
+	return nonseekable_open(inode, file);
+}
+
+static int psoc4_capture_release(struct inode *inode, struct file *file)
+{
+	struct psoc4_capture *capture = file->private_data;
+
+	mutex_lock(&psoc4_capture_lock);
+	psoc4_capture_detach(capture);
+	mutex_unlock(&psoc4_capture_lock);
+
+	psoc4_capture_free(capture);
+	return 0;
+}
+
+static bool psoc4_capture_readable(struct psoc4_capture *capture)
+{
+	return !kfifo_is_empty(&capture->fifo) || !READ_ONCE(capture->data);
+}
+
+// Read whole scan records
+static ssize_t psoc4_capture_read(struct file *file, char __user *buf, size_t count,
+									loff_t *ppos)
+{
+	struct psoc4_capture *capture = file->private_data;
+	unsigned int copied;
+	ssize_t ret;
+
+	if (count < capture->record_size)
+		return -EINVAL;
+	count -= count % capture->record_size;
+
+	if (mutex_lock_interruptible(&capture->read_lock))
+		return -ERESTARTSYS;
+
+	while (kfifo_is_empty(&capture->fifo)) {
+		if (!READ_ONCE(capture->data)) {
+			ret = 0;
+			goto unlock;
+		}
+		if (file->f_flags & O_NONBLOCK) {
+			ret = -EAGAIN;
+			goto unlock;
+		}
+		ret = wait_event_interruptible(capture->wait, psoc4_capture_readable(capture));
+		if (ret)
+			goto unlock;
+	}
+
+	// The fifo only holds whole records
+	ret = kfifo_to_user(&capture->fifo, buf, count, &copied);
+	if (ret == 0)
+		ret = copied;
+
+unlock:
+	mutex_unlock(&capture->read_lock);
+	return ret;
+}
+
+static __poll_t psoc4_capture_poll(struct file *file, poll_table *wait)
+{
+	struct psoc4_capture *capture = file->private_data;
+	__poll_t mask = 0;
+
+	poll_wait(file, &capture->wait, wait);
+
+	if (!kfifo_is_empty(&capture->fifo))
+		mask |= EPOLLIN | EPOLLRDNORM;
+	if (!READ_ONCE(capture->data))
+		mask |= EPOLLHUP;
+
+	return mask;
+}
+
+static const struct file_operations psoc4_capture_fops = {
+	.owner = THIS_MODULE,
+	.open = psoc4_capture_open,
+	.release = psoc4_capture_release,
+	.read = psoc4_capture_read,
+	.poll = psoc4_capture_poll,
+};
+
+// Create the sns_stream debugfs file of the device
+void psoc4_capture_create(struct i2c_client *client, struct dentry *dir)
+{
+	debugfs_create_file("sns_stream", 0400, dir, client, &psoc4_capture_fops);
+}
+
+// Stop a running capture, called once the debugfs files are removed
+// The open file keeps its records until it is closed.
+void psoc4_capture_remove(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	mutex_lock(&psoc4_capture_lock);
+	if (data->capture)
+		psoc4_capture_detach(data->capture);
+	mutex_unlock(&psoc4_capture_lock);
+}
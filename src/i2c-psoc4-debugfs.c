@@ -47,7 +47,10 @@
 
 #include "i2c-psoc4-driver.h"
 
+// Common root directory, holds one subdirectory per device
+static DEFINE_MUTEX(psoc4_debugfs_lock);
 static struct dentry *psoc4_debugfs_root;
+static unsigned int psoc4_debugfs_users;
 
 // debugfs attribute for touch0_pos (Read-Only)
 static int touch0_pos_seq_show(struct seq_file *s, void *v)
@@ -95,97 +98,78 @@ static int num_touch_seq_show(struct seq_file *s, void *v)
 	return 0;
 }
 
-// debugfs attribute for sns_raw (Read-Only)
-static int sns_raw_seq_show(struct seq_file *s, void *v)
+// Print one array of the sensor snapshot
+static void sns_print_u16(struct seq_file *s, const u16 *values, u8 num_sensors)
 {
-	struct i2c_client *client = to_i2c_client(s->private);
-	u8 num_sensors;
-	u16 *raw_data;
-	int ret, i;
-
-	ret = psoc4_read_register(client, REG_NUM_SNS, &num_sensors, REG_NUM_SNS_SIZE);
-	if (ret < 0)
-		return ret;
-
-	raw_data = kzalloc(REG_SNS_RAW_SIZE(num_sensors), GFP_KERNEL);
-	if (!raw_data)
-		return -ENOMEM;
-
-	ret = psoc4_read_register(client, REG_SNS_RAW, (u8 *)raw_data,
-					REG_SNS_RAW_SIZE(num_sensors));
-	if (ret < 0) {
-		kfree(raw_data);
-		return ret;
-	}
+	int i;
 
 	for (i = 0; i < num_sensors; i++)
-		seq_printf(s, "0x%04x ", le16_to_cpu(raw_data[i]));
+		seq_printf(s, "0x%04x ", values[i]);
 	seq_putc(s, '\n');
-
-	kfree(raw_data);
-	return 0;
 }
 
-// debugfs attribute for sns_bsln (Read-Only)
-static int sns_bsln_seq_show(struct seq_file *s, void *v)
+static void sns_print_u32(struct seq_file *s, const u32 *values, u8 num_sensors)
 {
-	struct i2c_client *client = to_i2c_client(s->private);
-	u8 num_sensors;
-	u16 *bsln_data;
-	int ret, i;
-
-	ret = psoc4_read_register(client, REG_NUM_SNS, &num_sensors, REG_NUM_SNS_SIZE);
-	if (ret < 0)
-		return ret;
-
-	bsln_data = kzalloc(REG_SNS_BSLN_SIZE(num_sensors), GFP_KERNEL);
-	if (!bsln_data)
-		return -ENOMEM;
-
-	ret = psoc4_read_register(client, REG_SNS_BSLN(num_sensors),
-				(u8 *)bsln_data, REG_SNS_BSLN_SIZE(num_sensors));
-	if (ret < 0) {
-		kfree(bsln_data);
-		return ret;
-	}
+	int i;
 
 	for (i = 0; i < num_sensors; i++)
-		seq_printf(s, "0x%04x ", le16_to_cpu(bsln_data[i]));
+		seq_printf(s, "0x%08x ", values[i]);
 	seq_putc(s, '\n');
-
-	kfree(bsln_data);
-	return 0;
 }
 
-// debugfs attribute for sns_cp_measure
-static int sns_cp_measure_seq_show(struct seq_file *s, void *v)
+// Arrays of the sensor snapshot printed by a debugfs file
+#define SNS_ARRAY_RAW	(1 << 0)
+#define SNS_ARRAY_BSLN	(1 << 1)
+#define SNS_ARRAY_CP	(1 << 2)
+
+// Read raw counts, baselines and Cp of all sensors in one transfer and print
+// the requested arrays, one line each
+static int sns_snapshot_show(struct seq_file *s, unsigned int arrays)
 {
-	struct i2c_client *client = to_i2c_client(s->private);
-	u8 num_sensors;
-	u32 *cp_data;
-	int ret, i;
+	struct psoc4_data *data = i2c_get_clientdata(to_i2c_client(s->private));
+	struct psoc4_sns_snapshot *snap = &data->sns_snapshot;
+	int ret;
 
-	ret = psoc4_read_register(client, REG_NUM_SNS, &num_sensors, REG_NUM_SNS_SIZE);
+	mutex_lock(&data->sns_lock);
+	ret = psoc4_read_sns_snapshot(data->client, snap);
 	if (ret < 0)
-		return ret;
+		goto unlock;
+
+	if (arrays & SNS_ARRAY_RAW)
+		sns_print_u16(s, snap->raw, snap->num_sns);
+	if (arrays & SNS_ARRAY_BSLN)
+		sns_print_u16(s, snap->bsln, snap->num_sns);
+	if (arrays & SNS_ARRAY_CP)
+		sns_print_u32(s, snap->cp, snap->num_sns);
+
+unlock:
+	mutex_unlock(&data->sns_lock);
+	return ret;
+}
 
-	cp_data = kzalloc(REG_SNS_CP_MEASURE_SIZE(num_sensors), GFP_KERNEL);
-	if (!cp_data)
-		return -ENOMEM;
+// debugfs attribute for sns_raw (Read-Only)
+static int sns_raw_seq_show(struct seq_file *s, void *v)
+{
+	return sns_snapshot_show(s, SNS_ARRAY_RAW);
+}
 
-	ret = psoc4_read_register(client, REG_SNS_CP_MEASURE(num_sensors),
-				(u8 *)cp_data, REG_SNS_CP_MEASURE_SIZE(num_sensors));
-	if (ret < 0) {
-		kfree(cp_data);
-		return ret;
-	}
+// debugfs attribute for sns_bsln (Read-Only)
+static int sns_bsln_seq_show(struct seq_file *s, void *v)
+{
+	return sns_snapshot_show(s, SNS_ARRAY_BSLN);
+}
 
-	for (i = 0; i < num_sensors; i++)
-		seq_printf(s, "0x%08x ", le32_to_cpu(cp_data[i]));
-	seq_putc(s, '\n');
+// debugfs attribute for sns_cp_measure
+static int sns_cp_measure_seq_show(struct seq_file *s, void *v)
+{
+	return sns_snapshot_show(s, SNS_ARRAY_CP);
+}
 
-	kfree(cp_data);
-	return 0;
+// debugfs attribute for sns_snapshot (Read-Only)
+// Raw counts, baselines and Cp of the same scan
+static int sns_snapshot_seq_show(struct seq_file *s, void *v)
+{
+	return sns_snapshot_show(s, SNS_ARRAY_RAW | SNS_ARRAY_BSLN | SNS_ARRAY_CP);
 }
 
 // debugfs attribute for gestures
@@ -210,7 +194,7 @@ static int num_sns_seq_show(struct seq_file *s, void *v)
 	u8 num_sensors;
 	int ret;
 
-	ret = psoc4_read_register(client, REG_NUM_SNS, &num_sensors, REG_NUM_SNS_SIZE);
+	ret = psoc4_read_num_sns(client, &num_sensors);
 	if (ret < 0)
 		return ret;
 
@@ -218,36 +202,89 @@ static int num_sns_seq_show(struct seq_file *s, void *v)
 	return 0;
 }
 
+// debugfs attribute for irq_thread_time (Read-Only)
+static int irq_thread_time_seq_show(struct seq_file *s, void *v)
+{
+	struct psoc4_data *data = i2c_get_clientdata(to_i2c_client(s->private));
+	struct psoc4_irq_time_stats stats;
+
+	mutex_lock(&data->event_lock);
+	stats = data->irq_time_stats;
+	mutex_unlock(&data->event_lock);
+
+	seq_printf(s, "%llu %llu %llu %llu\n", stats.last_ns, stats.max_ns,
+				stats.count ? div64_u64(stats.total_ns, stats.count) : 0, stats.count);
+	return 0;
+}
+
+// debugfs attribute for nl_drops (Read-Only)
+static int nl_drops_seq_show(struct seq_file *s, void *v)
+{
+	struct psoc4_data *data = i2c_get_clientdata(to_i2c_client(s->private));
+
+	seq_printf(s, "%ld\n", atomic_long_read(&data->nl_drops));
+	return 0;
+}
+
+// debugfs attribute for nl_subscriptions (Read-Only)
+static int nl_subscriptions_seq_show(struct seq_file *s, void *v)
+{
+	psoc4_nl_show_subscriptions(s);
+	return 0;
+}
+
 int psoc4_debugfs_create(struct i2c_client *client)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct dentry *dir;
+
+	mutex_lock(&psoc4_debugfs_lock);
 	if (!psoc4_debugfs_root) {
 		psoc4_debugfs_root = debugfs_create_dir("psoc4_capsense", NULL);
-		if (!psoc4_debugfs_root)
+		if (IS_ERR(psoc4_debugfs_root)) {
+			psoc4_debugfs_root = NULL;
+			mutex_unlock(&psoc4_debugfs_lock);
 			return -ENOMEM;
+		}
 	}
-
-	debugfs_create_devm_seqfile(&client->dev, "touch0_pos",
-				psoc4_debugfs_root, touch0_pos_seq_show);
-	debugfs_create_devm_seqfile(&client->dev, "touch1_pos",
-				psoc4_debugfs_root, touch1_pos_seq_show);
-	debugfs_create_devm_seqfile(&client->dev, "num_touch",
-				psoc4_debugfs_root, num_touch_seq_show);
-	debugfs_create_devm_seqfile(&client->dev, "sns_raw",
-				psoc4_debugfs_root, sns_raw_seq_show);
-	debugfs_create_devm_seqfile(&client->dev, "sns_bsln",
-				psoc4_debugfs_root, sns_bsln_seq_show);
-	debugfs_create_devm_seqfile(&client->dev, "sns_cp_measure",
-				psoc4_debugfs_root, sns_cp_measure_seq_show);
-	debugfs_create_devm_seqfile(&client->dev, "gestures_raw",
-				psoc4_debugfs_root, gestures_raw_seq_show);
-	debugfs_create_devm_seqfile(&client->dev, "num_sns",
-				psoc4_debugfs_root, num_sns_seq_show);
+	psoc4_debugfs_users++;
+	mutex_unlock(&psoc4_debugfs_lock);
+
+	// Per-device directory named after the I2C device, e.g. 1-000d
+	dir = debugfs_create_dir(dev_name(&client->dev), psoc4_debugfs_root);
+	data->debugfs_dir = dir;
+
+	debugfs_create_devm_seqfile(&client->dev, "touch0_pos", dir, touch0_pos_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "touch1_pos", dir, touch1_pos_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "num_touch", dir, num_touch_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "sns_raw", dir, sns_raw_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "sns_bsln", dir, sns_bsln_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "sns_cp_measure", dir, sns_cp_measure_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "sns_snapshot", dir, sns_snapshot_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "gestures_raw", dir, gestures_raw_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "num_sns", dir, num_sns_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "irq_thread_time", dir,
+								irq_thread_time_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "nl_drops", dir, nl_drops_seq_show);
+	debugfs_create_devm_seqfile(&client->dev, "nl_subscriptions", dir,
+								nl_subscriptions_seq_show);
+	psoc4_capture_create(client, dir);
 
 	return 0;
 }
 
-void psoc4_debugfs_remove(void)
+void psoc4_debugfs_remove(struct i2c_client *client)
 {
-	debugfs_remove(psoc4_debugfs_root);
-	psoc4_debugfs_root = NULL;
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	debugfs_remove_recursive(data->debugfs_dir);
+	data->debugfs_dir = NULL;
+	psoc4_capture_remove(client);
+
+	mutex_lock(&psoc4_debugfs_lock);
+	if (psoc4_debugfs_users && !--psoc4_debugfs_users) {
+		debugfs_remove(psoc4_debugfs_root);
+		psoc4_debugfs_root = NULL;
+	}
+	mutex_unlock(&psoc4_debugfs_lock);
 }
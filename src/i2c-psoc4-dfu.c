@@ -67,73 +67,135 @@ static struct CyBtldr_CommunicationsData dfu_comm_data = {
 	.MaxTransferSize = PSOC4_DFU_MAX_TRANSFER_SIZE
 };
 
-static struct i2c_client *dfu_client;
-static u32 dfu_address;
+// The bootloader library keeps its state in globals and its callbacks take no
+// context, so only one device can be updated at a time.
+static DEFINE_MUTEX(dfu_lock);
+static struct psoc4_data *dfu_data; // Device being updated, guarded by dfu_lock
 
-static bool isPacketStarted = true; // Tracks status of reading response packet
-static bool isDfuUpdateSuccess = true; // Tracks if DFU update was successful
+void psoc4_dfu_init(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	data->dfu.packet_started = true;
+	data->dfu.success = true;
+}
 
-int psoc4_dfu_start(struct i2c_client *client)
+static int psoc4_dfu_start(struct i2c_client *client)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
 	struct device_node *of_node = client->dev.of_node;
 	int ret;
 
-	isPacketStarted = false; // Reset packet status
-	isDfuUpdateSuccess = false; // Reset status before starting DFU
-
-	if (!client) {
-		dev_err(&client->dev, "Invalid I2C client pointer\n");
-		return -EINVAL;
-	}
+	data->dfu.packet_started = false; // Reset packet status
+	data->dfu.success = false; // Reset status before starting DFU
 
-	ret = of_property_read_u32(of_node, "dfu-address", &dfu_address);
+	ret = of_property_read_u32(of_node, "dfu-address", &data->dfu.address);
 	if (ret < 0) {
 		dev_err(&client->dev, "Failed to read dfu-address\n");
 		return ret;
 	}
-	dev_dbg(&client->dev, "DFU address: 0x%02x\n", dfu_address);
+	dev_dbg(&client->dev, "DFU address: 0x%02x\n", data->dfu.address);
 
-	dfu_client = client;
+	dfu_data = data;
 
-	ret = psoc4_dfu_jump_to_bootloader(dfu_client);
+	ret = psoc4_dfu_jump_to_bootloader(client);
 	if (ret < 0) {
-		dev_err(&dfu_client->dev, "Failed to jump to bootloader\n");
+		dev_err(&client->dev, "Failed to jump to bootloader\n");
 		return ret;
 	}
 
+	// The application is replaced, none of the cached registers are valid
+	psoc4_reg_cache_invalidate(client);
+
 	return 0;
 }
 
-int psoc4_dfu_program(char *dfu_filepath)
+static int psoc4_dfu_program(struct i2c_client *client, const struct CyBtldr_Image *image)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
 	int ret;
 
-	if (!dfu_filepath) {
-		dev_err(&dfu_client->dev, "Invalid DFU file path\n");
-		return -EINVAL;
-	}
-
 	ret = psoc4_dfu_is_bootloader_mode(&dfu_comm_data);
 	if (ret == CYRET_SUCCESS) {
 		/* Program */
-		ret = CyBtldr_Program(dfu_filepath, &dfu_comm_data, NULL);
+		ret = CyBtldr_Program(image, &dfu_comm_data, NULL);
 		if (ret != CYRET_SUCCESS) {
-			dev_err(&dfu_client->dev, "DFU programming failed: %d\n", ret);
-			isDfuUpdateSuccess = false;
+			dev_err(&client->dev, "DFU programming failed: %d\n", ret);
+			data->dfu.success = false;
 			return ret;
 		}
-		dev_info(&dfu_client->dev, "DFU programming succeeded\n");
-		isDfuUpdateSuccess = true;
+		dev_info(&client->dev, "DFU programming succeeded\n");
+		data->dfu.success = true;
 	} else {
-		dev_err(&dfu_client->dev, "Device is not in bootloader mode, cannot program\n");
+		dev_err(&client->dev, "Device is not in bootloader mode, cannot program\n");
 		return -EBUSY;
 	}
 
-	psoc4_dfu_deinit();
+	psoc4_reg_cache_invalidate(client);
 
 	return 0;
 }
 
+/* Updating the firmware of a device
+ * Loads the whole image through the firmware loader and decodes it, then jumps
+ * to the bootloader and programs the decoded rows. Updates of different
+ * devices are serialized.
+ */
+int psoc4_dfu_update(struct i2c_client *client, const char *fw_name)
+{
+	const struct firmware *fw;
+	struct CyBtldr_Image *image;
+	int ret;
+
+	// Load and decode the image before the application is stopped
+	ret = firmware_request_nowarn(&fw, fw_name, &client->dev);
+	if (ret < 0) {
+		dev_err(&client->dev, "Failed to load firmware %s: %d\n", fw_name, ret);
+		return ret;
+	}
+
+	if (fw->size == 0 || fw->size > U32_MAX) {
+		dev_err(&client->dev, "Invalid firmware size: %zu\n", fw->size);
+		release_firmware(fw);
+		return -EINVAL;
+	}
+
+	ret = CyBtldr_ParseImage(fw->data, fw->size, &image);
+	release_firmware(fw);
+	if (ret != CYRET_SUCCESS) {
+		dev_err(&client->dev, "Invalid firmware image %s: %d\n", fw_name, ret);
+		return -EINVAL;
+	}
+
+	mutex_lock(&dfu_lock);
+
+	// All command buffers of the update are allocated before the application stops
+	ret = CyBtldr_CreateSession();
+	if (ret != CYRET_SUCCESS) {
+		dev_err(&client->dev, "Failed to allocate DFU session\n");
+		goto unlock;
+	}
+
+	ret = psoc4_dfu_start(client);
+	if (ret < 0) {
+		dev_err(&client->dev, "Failed to start DFU update: %d\n", ret);
+		goto out;
+	}
+
+	dev_info(&client->dev, "DFU update started with firmware: %s (%u rows)\n",
+				fw_name, image->numRows);
+
+	ret = psoc4_dfu_program(client, image);
+
+out:
+	psoc4_dfu_deinit();
+	CyBtldr_DestroySession();
+unlock:
+	mutex_unlock(&dfu_lock);
+	CyBtldr_FreeImage(image);
+	return ret;
+}
+
 int psoc4_dfu_jump_to_bootloader(struct i2c_client *client)
 {
 	int ret;
@@ -149,14 +211,16 @@ int psoc4_dfu_jump_to_bootloader(struct i2c_client *client)
 	return 0;
 }
 
-bool psoc4_dfu_get_status(void)
+bool psoc4_dfu_get_status(struct i2c_client *client)
 {
-	return isDfuUpdateSuccess;
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	return data->dfu.success;
 }
 
 static void psoc4_dfu_deinit(void)
 {
-	dfu_client = NULL;
+	dfu_data = NULL;
 }
 
 static int psoc4_dfu_is_bootloader_mode(struct CyBtldr_CommunicationsData *comm)
@@ -165,7 +229,7 @@ static int psoc4_dfu_is_bootloader_mode(struct CyBtldr_CommunicationsData *comm)
 
 	ret = CyBtldr_isBootloaderAppActive(comm);
 	if (ret < 0) {
-		dev_err(&dfu_client->dev, "Target FW is not in Bootloader.\n");
+		dev_err(&dfu_data->client->dev, "Target FW is not in Bootloader.\n");
 		return ret;
 	}
 
@@ -174,8 +238,8 @@ static int psoc4_dfu_is_bootloader_mode(struct CyBtldr_CommunicationsData *comm)
 
 static int _dfu_open_connection(void)
 {
-	if (!dfu_client || !dfu_client->adapter) {
-		dev_err(&dfu_client->dev, "DFU I2C adapter not initialized\n");
+	if (!dfu_data || !dfu_data->client->adapter) {
+		pr_err("DFU I2C adapter not initialized\n");
 		return -ENODEV;
 	}
 	return 0;
@@ -189,7 +253,7 @@ static int _dfu_close_connection(void)
 static int _dfu_read_data_internal(u8 *buffer, int size)
 {
 	struct i2c_msg msg = {
-		.addr = (u16)dfu_address,
+		.addr = (u16)dfu_data->dfu.address,
 		.flags = I2C_M_RD, // Read
 		.len = size,
 		.buf = buffer
@@ -197,9 +261,9 @@ static int _dfu_read_data_internal(u8 *buffer, int size)
 
 	int ret;
 
-	ret = i2c_transfer(dfu_client->adapter, &msg, 1);
+	ret = i2c_transfer(dfu_data->client->adapter, &msg, 1);
 	if (ret < 0) {
-		dev_err(&dfu_client->dev, "I2C read error: %d\n", ret);
+		dev_err(&dfu_data->client->dev, "I2C read error: %d\n", ret);
 		return ret;
 	}
 
@@ -217,7 +281,7 @@ static bool _dfu_read_first_good_data(u8 *data)
 	while (!dataIsGood && numReads < MAX_READS) {
 		err = _dfu_read_data_internal(data, 1); // Read one byte
 		if (err < 0) {
-			dev_err(&dfu_client->dev, "Error reading first byte: %d\n", err);
+			dev_err(&dfu_data->client->dev, "Error reading first byte: %d\n", err);
 			return false;
 		}
 
@@ -226,7 +290,7 @@ static bool _dfu_read_first_good_data(u8 *data)
 		if (!dataIsGood)
 			usleep_range(10000, 11000); // Delay for 10ms
 		else if (data[0] == DFU_PACKET_START)
-			isPacketStarted = true;
+			dfu_data->dfu.packet_started = true;
 	}
 
 	return dataIsGood;
@@ -240,24 +304,24 @@ static int _dfu_read_data(u8 *data, int size)
 	// Initial read for the full packet
 	err = _dfu_read_data_internal(data, size);
 	if (err < 0) {
-		dev_err(&dfu_client->dev, "Initial read failed: %d\n", err);
+		dev_err(&dfu_data->client->dev, "Initial read failed: %d\n", err);
 		return err;
 	}
 
 	int numGoodBytes;
 	int i; // Index of the first good data received.
 
-	if (!isPacketStarted) {
+	if (!dfu_data->dfu.packet_started) {
 		// Process the data to find the first good byte
 		for (i = 0; i < size; i++) {
 			if (data[i] == DFU_PACKET_START)
-				isPacketStarted = true;
+				dfu_data->dfu.packet_started = true;
 
 			if (data[i] != DFU_BAD_STATUS_DATA)
 				break;
 		}
 		if (i == 0 && data[size - 1] == DFU_PACKET_END)
-			isPacketStarted = false;
+			dfu_data->dfu.packet_started = false;
 
 		if (i != 0) {
 
@@ -280,21 +344,21 @@ static int _dfu_read_data(u8 *data, int size)
 				err = _dfu_read_data_internal(&data[numGoodBytes],
 						size - numGoodBytes);
 				if (err < 0) {
-					dev_err(&dfu_client->dev,
+					dev_err(&dfu_data->client->dev,
 							"Failed to read remaining data: %d\n",
 							err);
 					return err;
 				}
 				if (data[size - 1] == DFU_PACKET_END)
-					isPacketStarted = false;
+					dfu_data->dfu.packet_started = false;
 			} else if (!dataIsGood) {
-				dev_err(&dfu_client->dev, "No good data received after initial read\n");
+				dev_err(&dfu_data->client->dev, "No good data received after initial read\n");
 				err = 0x01; //OPERATION_TIMEOUT
 			}
 		}
 	} else {
 		if (data[size - 1] == DFU_PACKET_END)
-			isPacketStarted = false;
+			dfu_data->dfu.packet_started = false;
 	}
 
 	return err;
@@ -305,15 +369,15 @@ static int _dfu_write_data(u8 *buffer, int size)
 	int ret;
 
 	struct i2c_msg msg = {
-		.addr = (u16)dfu_address,
+		.addr = (u16)dfu_data->dfu.address,
 		.flags = 0, // Write
 		.len = size,
 		.buf = buffer
 	};
 
-	ret = i2c_transfer(dfu_client->adapter, &msg, 1);
+	ret = i2c_transfer(dfu_data->client->adapter, &msg, 1);
 	if (ret < 0) {
-		dev_err(&dfu_client->dev, "DFU I2C write error: %d\n", ret);
+		dev_err(&dfu_data->client->dev, "DFU I2C write error: %d\n", ret);
 		return CYRET_ERR_DATA;
 	}
 
@@ -0,0 +1,342 @@
+// SPDX-License-Identifier: GPL-2.0 OR MIT
+/*
+ * Copyright (C) 2025, Infineon Technologies AG, or an affiliate of Infineon Technologies AG.
+ * All rights reserved.
+ *
+ * Licensed under either of
+ *
+ * GNU General Public License, Version 2.0 <https://www.gnu.org/licenses/gpl-2.0.html>
+ * MIT license  <http://opensource.org/licenses/MIT>
+ *
+ * at your option.
+ *
+ * When Licensed under the GNU General Public License, Version 2.0 (the "License");
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/gpl-2.0.html>
+ *
+ * When licensed under the MIT license;
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the “Software”), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "i2c-psoc4-driver.h"
+
+#if defined(IIO_SENSOR_DATA)
+
+#include <linux/iio/iio.h>
+#include <linux/iio/buffer.h>
+#include <linux/iio/trigger.h>
+#include <linux/iio/trigger_consumer.h>
+#include <linux/iio/triggered_buffer.h>
+#include <linux/unaligned.h>
+
+#if !IS_ENABLED(CONFIG_IIO_TRIGGERED_BUFFER)
+#error "IIO_SENSOR_DATA requires a kernel with CONFIG_IIO_TRIGGERED_BUFFER enabled!"
+#endif
+
+// Sensor arrays exposed as IIO channels, in register order
+enum psoc4_iio_array {
+	PSOC4_IIO_RAW,
+	PSOC4_IIO_BSLN,
+	PSOC4_IIO_CP,
+	PSOC4_IIO_ARRAYS,
+};
+
+// Layout of a sensor array, relative to REG_SNS_RAW
+static const struct {
+	const char *name;	// Channel name suffix
+	u8 size;		// Bytes per sensor
+	u8 offset;		// Start of the array, in bytes per sensor
+} psoc4_iio_arrays[PSOC4_IIO_ARRAYS] = {
+	[PSOC4_IIO_RAW] = { NULL, 2, 0 },
+	[PSOC4_IIO_BSLN] = { "baseline", 2, 2 },
+	[PSOC4_IIO_CP] = { "cp", 4, 4 },
+};
+
+// Driver data of the IIO device
+struct psoc4_iio {
+	struct i2c_client *client;
+	struct iio_trigger *trig;	// Fired by the scan complete interrupt
+	u8 num_sns;			// Number of sensors when the device was probed
+	u8 *regs;			// Sensor registers, REG_SNS_RAW to the end of SNS_CP_MEASURE
+	u8 *scan;			// Scan elements pushed to the buffer
+};
+
+// Register offset of a channel, relative to REG_SNS_RAW
+static unsigned int psoc4_iio_chan_offset(struct psoc4_iio *iio,
+										const struct iio_chan_spec *chan)
+{
+	unsigned int size = psoc4_iio_arrays[chan->address].size;
+
+	return psoc4_iio_arrays[chan->address].offset * iio->num_sns + size * chan->channel;
+}
+
+static int psoc4_iio_read_raw(struct iio_dev *indio_dev, const struct iio_chan_spec *chan,
+							int *val, int *val2, long mask)
+{
+	struct psoc4_iio *iio = iio_priv(indio_dev);
+	u8 buf[4];
+	int ret;
+
+	if (mask != IIO_CHAN_INFO_RAW)
+		return -EINVAL;
+
+	ret = iio_device_claim_direct_mode(indio_dev);
+	if (ret)
+		return ret;
+
+	ret = psoc4_read_register(iio->client, REG_SNS_RAW + psoc4_iio_chan_offset(iio, chan),
+							buf, psoc4_iio_arrays[chan->address].size);
+	iio_device_release_direct_mode(indio_dev);
+	if (ret < 0)
+		return ret;
+
+	if (chan->address == PSOC4_IIO_CP)
+		*val = get_unaligned_le32(buf);
+	else
+		*val = get_unaligned_le16(buf);
+
+	return IIO_VAL_INT;
+}
+
+static const struct iio_info psoc4_iio_info = {
+	.read_raw = psoc4_iio_read_raw,
+};
+
+// Read all sensor arrays in one transfer and push the enabled channels
+static irqreturn_t psoc4_iio_trigger_handler(int irq, void *p)
+{
+	struct iio_poll_func *pf = p;
+	struct iio_dev *indio_dev = pf->indio_dev;
+	struct psoc4_iio *iio = iio_priv(indio_dev);
+	struct psoc4_data *data = i2c_get_clientdata(iio->client);
+	unsigned int offset = 0, size, bit;
+	s64 timestamp;
+	int ret;
+
+	ret = psoc4_read_register(iio->client, REG_SNS_RAW, iio->regs,
+							REG_SNS_DATA_SIZE(iio->num_sns));
+	if (ret < 0) {
+		dev_err_ratelimited(&iio->client->dev, "Failed to read sensor data: %d\n", ret);
+		goto done;
+	}
+
+	// Scan elements are aligned to their own size
+	iio_for_each_active_channel(indio_dev, bit) {
+		const struct iio_chan_spec *chan = &indio_dev->channels[bit];
+
+		if (chan->type == IIO_TIMESTAMP)
+			continue;
+
+		size = psoc4_iio_arrays[chan->address].size;
+		offset = ALIGN(offset, size);
+		memcpy(iio->scan + offset, iio->regs + psoc4_iio_chan_offset(iio, chan), size);
+		offset += size;
+	}
+
+	// Our own trigger runs in the IRQ thread, use the time of the interrupt
+	// moved to the clock selected for the buffer
+	if (iio_trigger_using_own(indio_dev))
+		timestamp = ktime_to_ns(data->event_time) + iio_get_time_ns(indio_dev) -
+					ktime_get_ns();
+	else
+		timestamp = iio_get_time_ns(indio_dev);
+
+	iio_push_to_buffers_with_timestamp(indio_dev, iio->scan, timestamp);
+
+done:
+	iio_trigger_notify_done(indio_dev->trig);
+	return IRQ_HANDLED;
+}
+
+// The trigger enables the scan complete interrupt while it is in use
+static int psoc4_iio_set_trigger_state(struct iio_trigger *trig, bool state)
+{
+	struct psoc4_iio *iio = iio_trigger_get_drvdata(trig);
+
+	if (!state) {
+		psoc4_scan_irq_put(iio->client);
+		return 0;
+	}
+
+	return psoc4_scan_irq_get(iio->client);
+}
+
+static const struct iio_trigger_ops psoc4_iio_trigger_ops = {
+	.set_trigger_state = psoc4_iio_set_trigger_state,
+	.validate_device = iio_trigger_validate_own_device,
+};
+
+// Fire the trigger for a completed scan
+// Called with the event lock held, from the IRQ thread or the poll work
+void psoc4_iio_scan(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_iio *iio;
+
+	if (!data->indio_dev)
+		return;
+
+	iio = iio_priv(data->indio_dev);
+	iio_trigger_poll_nested(iio->trig);
+}
+
+// One channel per sensor and array, followed by the timestamp
+static int psoc4_iio_init_channels(struct iio_dev *indio_dev)
+{
+	struct psoc4_iio *iio = iio_priv(indio_dev);
+	struct iio_chan_spec *channels, *chan;
+	unsigned int array, sns;
+
+	channels = devm_kcalloc(&iio->client->dev, PSOC4_IIO_ARRAYS * iio->num_sns + 1,
+							sizeof(*channels), GFP_KERNEL);
+	if (!channels)
+		return -ENOMEM;
+
+	chan = channels;
+	for (array = 0; array < PSOC4_IIO_ARRAYS; array++) {
+		for (sns = 0; sns < iio->num_sns; sns++, chan++) {
+			chan->type = IIO_CAPACITANCE;
+			chan->indexed = 1;
+			chan->channel = sns;
+			chan->address = array;
+			chan->extend_name = psoc4_iio_arrays[array].name;
+			chan->info_mask_separate = BIT(IIO_CHAN_INFO_RAW);
+			chan->scan_index = chan - channels;
+			chan->scan_type.sign = 'u';
+			chan->scan_type.realbits = 8 * psoc4_iio_arrays[array].size;
+			chan->scan_type.storagebits = 8 * psoc4_iio_arrays[array].size;
+			chan->scan_type.endianness = IIO_LE;
+		}
+	}
+	*chan = (struct iio_chan_spec)IIO_CHAN_SOFT_TIMESTAMP(chan - channels);
+
+	indio_dev->channels = channels;
+	indio_dev->num_channels = chan - channels + 1;
+	return 0;
+}
+
+// Register the IIO device with its trigger and triggered buffer
+int psoc4_iio_create(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct iio_dev *indio_dev;
+	struct psoc4_iio *iio;
+	size_t regs_size;
+	int ret;
+
+	indio_dev = devm_iio_device_alloc(&client->dev, sizeof(*iio));
+	if (!indio_dev)
+		return -ENOMEM;
+
+	iio = iio_priv(indio_dev);
+	iio->client = client;
+
+	// The channels are fixed once registered, a DFU changing the number of
+	// sensors takes effect after the driver is bound again
+	ret = psoc4_read_num_sns(client, &iio->num_sns);
+	if (ret < 0)
+		return ret;
+	if (iio->num_sns == 0) {
+		dev_err(&client->dev, "No sensors to expose\n");
+		return -ENODEV;
+	}
+
+	regs_size = REG_SNS_DATA_SIZE(iio->num_sns);
+	iio->regs = devm_kzalloc(&client->dev, regs_size, GFP_KERNEL);
+	// Scan elements padded to their alignment, followed by the timestamp
+	iio->scan = devm_kzalloc(&client->dev, ALIGN(regs_size + sizeof(u16), sizeof(s64)) +
+							sizeof(s64), GFP_KERNEL);
+	if (!iio->regs || !iio->scan)
+		return -ENOMEM;
+
+	ret = psoc4_iio_init_channels(indio_dev);
+	if (ret)
+		return ret;
+
+	indio_dev->name = "psoc4_capsense";
+	indio_dev->info = &psoc4_iio_info;
+	indio_dev->modes = INDIO_DIRECT_MODE;
+
+	iio->trig = devm_iio_trigger_alloc(&client->dev, "%s-dev%d", indio_dev->name,
+									iio_device_id(indio_dev));
+	if (!iio->trig)
+		return -ENOMEM;
+
+	iio->trig->ops = &psoc4_iio_trigger_ops;
+	iio_trigger_set_drvdata(iio->trig, iio);
+
+	ret = iio_trigger_register(iio->trig);
+	if (ret)
+		return ret;
+	indio_dev->trig = iio_trigger_get(iio->trig);
+
+	ret = iio_triggered_buffer_setup(indio_dev, NULL, psoc4_iio_trigger_handler, NULL);
+	if (ret)
+		goto unregister_trigger;
+
+	ret = iio_device_register(indio_dev);
+	if (ret)
+		goto cleanup_buffer;
+
+	mutex_lock(&data->event_lock);
+	data->indio_dev = indio_dev;
+	mutex_unlock(&data->event_lock);
+
+	dev_dbg(&client->dev, "Registered IIO device for %u sensors\n", iio->num_sns);
+	return 0;
+
+cleanup_buffer:
+	iio_triggered_buffer_cleanup(indio_dev);
+unregister_trigger:
+	iio_trigger_unregister(iio->trig);
+	return ret;
+}
+
+// Unregister the IIO device, called once the device stopped reporting frames
+void psoc4_iio_remove(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct iio_dev *indio_dev = data->indio_dev;
+	struct psoc4_iio *iio;
+
+	if (!indio_dev)
+		return;
+
+	mutex_lock(&data->event_lock);
+	data->indio_dev = NULL;
+	mutex_unlock(&data->event_lock);
+
+	iio = iio_priv(indio_dev);
+	iio_device_unregister(indio_dev);
+	iio_triggered_buffer_cleanup(indio_dev);
+	iio_trigger_unregister(iio->trig);
+}
+
+#endif /* #if defined(IIO_SENSOR_DATA) */
@@ -48,10 +48,10 @@
 #include "i2c-psoc4-driver.h"
 #include "input-report-config.h"
 
-static struct input_dev *touchpad_input_dev;
-
 int psoc4_input_dev_create(struct i2c_client *client)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct input_dev *touchpad_input_dev;
 	int ret;
 	struct device_node *of_node = client->dev.of_node;
 
@@ -108,22 +108,42 @@ int psoc4_input_dev_create(struct i2c_client *client)
 	if (ret)
 		return ret;
 
+	data->input_dev = touchpad_input_dev;
+
 	dev_info(&client->dev, "Input device registered successfully\n");
 	return 0;
 }
 
 void psoc4_input_dev_remove(struct i2c_client *client)
 {
-	if (touchpad_input_dev) {
-		input_unregister_device(touchpad_input_dev);
-		touchpad_input_dev = NULL;
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	if (data->input_dev) {
+		input_unregister_device(data->input_dev);
+		data->input_dev = NULL;
 	}
 	dev_info(&client->dev, "Input device unregistered successfully\n");
 }
 
+/* Closing an input frame
+ * Events are stamped with the time the interrupt was raised instead of the
+ * time the IRQ thread gets to report them.
+ */
+static void psoc4_input_sync(struct i2c_client *client, struct input_dev *touchpad_input_dev)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	if (data->event_time)
+		input_set_timestamp(touchpad_input_dev, data->event_time);
+	input_sync(touchpad_input_dev);
+}
+
 void psoc4_input_report_coord(struct i2c_client *client, u8 num_touches,
 								struct psoc4_touch *touches)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct input_dev *touchpad_input_dev = data->input_dev;
+
 	if (!touchpad_input_dev) {
 		dev_err(&client->dev, "Trying to report, but input device not registered\n");
 		return;
@@ -162,11 +182,14 @@ void psoc4_input_report_coord(struct i2c_client *client, u8 num_touches,
 	}
 #endif /* #if defined(REPORT_LEGACY_COORDS) */
 
-	input_sync(touchpad_input_dev);
+	psoc4_input_sync(client, touchpad_input_dev);
 }
 
 void psoc4_input_report_gesture(struct i2c_client *client, u32 gestures)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct input_dev *touchpad_input_dev = data->input_dev;
+
 	if (!touchpad_input_dev) {
 		dev_err(&client->dev, "Trying to report gesture, but input device not registered\n");
 		return;
@@ -174,12 +197,12 @@ void psoc4_input_report_gesture(struct i2c_client *client, u32 gestures)
 
 	if (gestures & GEST_ONE_FINGER_SINGLE_CLICK) {
 		dev_dbg(&client->dev, "One-finger single click gesture detected\n");
-		report_instant_event(GEST_SINGLE_CLICK_KEY);
+		report_instant_event(client, GEST_SINGLE_CLICK_KEY);
 	}
 
 	if (gestures & GEST_ONE_FINGER_DOUBLE_CLICK) {
 		dev_dbg(&client->dev, "One-finger double click gesture detected\n");
-		report_instant_event(GEST_DOUBLE_CLICK_KEY);
+		report_instant_event(client, GEST_DOUBLE_CLICK_KEY);
 	}
 
 	if (gestures & GEST_ONE_FINGER_SCROLL) {
@@ -210,19 +233,19 @@ void psoc4_input_report_gesture(struct i2c_client *client, u32 gestures)
 		switch (flick_direction) {
 		case GEST_DIRECTION_UP:
 			dev_dbg(&client->dev, "One-finger flick gesture detected: UP\n");
-			report_instant_event(GEST_SWIPE_UP_KEY);
+			report_instant_event(client, GEST_SWIPE_UP_KEY);
 			break;
 		case GEST_DIRECTION_DOWN:
 			dev_dbg(&client->dev, "One-finger flick gesture detected: DOWN\n");
-			report_instant_event(GEST_SWIPE_DOWN_KEY);
+			report_instant_event(client, GEST_SWIPE_DOWN_KEY);
 			break;
 		case GEST_DIRECTION_RIGHT:
 			dev_dbg(&client->dev, "One-finger flick gesture detected: RIGHT\n");
-			report_instant_event(GEST_SWIPE_RIGHT_KEY);
+			report_instant_event(client, GEST_SWIPE_RIGHT_KEY);
 			break;
 		case GEST_DIRECTION_LEFT:
 			dev_dbg(&client->dev, "One-finger flick gesture detected: LEFT\n");
-			report_instant_event(GEST_SWIPE_LEFT_KEY);
+			report_instant_event(client, GEST_SWIPE_LEFT_KEY);
 			break;
 		default:
 			dev_warn(&client->dev, "Unknown one-finger flick direction: 0x%02x\n",
@@ -234,19 +257,22 @@ void psoc4_input_report_gesture(struct i2c_client *client, u32 gestures)
 	if (gestures & GEST_TOUCHDOWN) {
 		dev_dbg(&client->dev, "Touchdown event detected\n");
 		input_report_key(touchpad_input_dev, GEST_TOUCHDOWN_KEY, 1);
-		input_sync(touchpad_input_dev);
+		psoc4_input_sync(client, touchpad_input_dev);
 	}
 
 	if (gestures & GEST_LIFTOFF) {
 		dev_dbg(&client->dev, "Liftoff event detected\n");
 		input_report_key(touchpad_input_dev, GEST_TOUCHDOWN_KEY, 0);
-		input_sync(touchpad_input_dev);
+		psoc4_input_sync(client, touchpad_input_dev);
 	}
 #endif /* #if defined(TOUCHDOWN_LIFTOFF_ON_GESTURE) */
 }
 
 void psoc4_input_report_liftoff_touchdown(struct i2c_client *client, u8 num_touches)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct input_dev *touchpad_input_dev = data->input_dev;
+
 	if (!touchpad_input_dev) {
 		dev_err(&client->dev, "Trying to report liftoff/touchdown, but input device not registered\n");
 		return;
@@ -257,13 +283,16 @@ void psoc4_input_report_liftoff_touchdown(struct i2c_client *client, u8 num_touc
 	else
 		input_report_key(touchpad_input_dev, GEST_TOUCHDOWN_KEY, 0);
 
-	input_sync(touchpad_input_dev);
+	psoc4_input_sync(client, touchpad_input_dev);
 }
 
-void report_instant_event(u32 key_code)
+void report_instant_event(struct i2c_client *client, u32 key_code)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct input_dev *touchpad_input_dev = data->input_dev;
+
 	input_report_key(touchpad_input_dev, key_code, 1);
-	input_sync(touchpad_input_dev);
+	psoc4_input_sync(client, touchpad_input_dev);
 	input_report_key(touchpad_input_dev, key_code, 0);
-	input_sync(touchpad_input_dev);
+	psoc4_input_sync(client, touchpad_input_dev);
 }
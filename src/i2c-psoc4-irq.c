@@ -47,269 +47,464 @@
 
 #include "i2c-psoc4-driver.h"
 
-static struct sock *nl_socket;
-
-// Helper to send netlink message
-static void psoc4_send_nl_msg(const char *msg)
+// Hard interrupt handler, records the time the interrupt was raised
+static irqreturn_t psoc4_irq_hardirq(int irq, void *dev_id)
 {
-	struct sk_buff *skb;
-	struct nlmsghdr *nlh;
-	int msg_size = strlen(msg);
-	int ret;
-
-	if (!nl_socket)
-		return;
-
-	skb = nlmsg_new(msg_size, GFP_KERNEL);
-	if (!skb) {
-		pr_err("Netlink: Failed to allocate skb\n");
-		return;
-	}
-
-	nlh = nlmsg_put(skb, 0, 0, NLMSG_DONE, msg_size, 0);
-	if (!nlh) {
-		pr_err("Netlink: Failed to put message header\n");
-		kfree_skb(skb);
-		return;
-	}
-	memcpy(nlmsg_data(nlh), msg, msg_size);
-
-	ret = nlmsg_multicast(nl_socket, skb, 0, NETLINK_GROUP, GFP_KERNEL);
-	if (ret < 0) {
-	    if (ret == -ESRCH) {
-	        pr_debug("Netlink: No listeners on multicast group %d\n", NETLINK_GROUP);
-	    } else {
-	        pr_err("Netlink: multicast send failed: %d\n", ret);
-	    }
-	}
+	struct i2c_client *client = dev_id;
+	struct psoc4_data *data = i2c_get_clientdata(client);
 
-	pr_debug("Netlink: Sent message: %s\n", msg);
+	data->irq_time = ktime_get();
+	return IRQ_WAKE_THREAD;
 }
 
-static int psoc4_nl_init(void)
+// Account the time spent in the IRQ thread
+// Called with the event lock held
+static void psoc4_irq_account_time(struct psoc4_data *data, ktime_t elapsed)
 {
-	struct netlink_kernel_cfg cfg = {
-		.input = NULL,
-	};
-
-	nl_socket = netlink_kernel_create(&init_net, NETLINK_USER_TYPE, &cfg);
-	if (!nl_socket) {
-		pr_err("Netlink: Failed to create socket\n");
-		return -ENOMEM;
-	}
+	struct psoc4_irq_time_stats *stats = &data->irq_time_stats;
+	u64 ns = ktime_to_ns(elapsed);
 
-	pr_debug("Netlink: Created socket for interrupts\n");
-	return 0;
+	stats->last_ns = ns;
+	stats->max_ns = max(stats->max_ns, ns);
+	stats->total_ns += ns;
+	stats->count++;
 }
 
-void psoc4_nl_exit(void)
+// Clear the handled bits of INT_STATUS
+// Bits raised by the firmware after the frame was read stay pending, unless
+// they are raised inside this read-modify-write: INT_STATUS is a plain
+// register without write-1-to-clear, so the write puts back the value read one
+// bus transaction earlier and a bit raised in between is lost.
+static void psoc4_irq_ack(struct i2c_client *client, u8 handled)
 {
-	if (nl_socket) {
-		netlink_kernel_release(nl_socket);
-		nl_socket = NULL;
-	}
-	pr_debug("Netlink: Released socket\n");
-}
+	int ret;
 
-static int irq_number;
+	if (!handled)
+		return;
 
-// Interrupt handler
-static irqreturn_t psoc4_irq_handler(int irq, void *dev_id)
+	ret = psoc4_update_register(client, REG_INT_STATUS, handled, 0);
+	if (ret < 0)
+		dev_err(&client->dev, "Failed to clear INT_STATUS bits 0x%02x\n", handled);
+}
+
+// Handle the events of one frame
+// Called with the event lock held, from the IRQ thread or the poll work
+static int psoc4_process_events(struct i2c_client *client, struct psoc4_frame *frame)
 {
-	struct i2c_client *client = dev_id;
-	u8 int_status;
+	u8 int_status = frame->int_status;
 	int ret;
-	char msg[NETLINK_MSG_LEN];
-
-	// Read the INT_STATUS register
-	ret = psoc4_read_register(client, REG_INT_STATUS, &int_status, REG_INT_STATUS_SIZE);
-	if (ret < 0) {
-		dev_err(&client->dev, "Failed to read INT_STATUS register\n");
-		psoc4_irq_clear(client);
-		return IRQ_NONE;
-	}
 
 	dev_dbg(&client->dev, "INT_STATUS: 0x%02x\n", int_status);
 
-	// Handle each interrupt type and notify user space
+	// Handle each interrupt type
 	if (int_status & INT_STATUS_SCAN_COMPLETE) {
 		dev_dbg(&client->dev, "Scan Complete interrupt\n");
-		snprintf(msg, sizeof(msg), "SCAN_COMPLETE");
-		psoc4_send_nl_msg(msg);
-		// Add specific handling for Scan Complete
+		psoc4_capture_scan(client);
+		psoc4_iio_scan(client);
 	}
 	if (int_status & INT_STATUS_TOUCH_DETECTED) {
 		dev_dbg(&client->dev, "Touch Detected interrupt\n");
-		snprintf(msg, sizeof(msg), "TOUCH_DETECTED");
-		psoc4_send_nl_msg(msg);
-		ret = psoc4_touch_detected_handler(client);
+		ret = psoc4_touch_detected_handler(client, frame);
 		if (ret < 0)
-			return IRQ_NONE; // No touch detected, exit early
+			return ret; // No touch detected, exit early
 	}
 	if (int_status & INT_STATUS_TEST_RESULT_READY) {
 		dev_info(&client->dev, "Test Result Ready interrupt\n");
-		snprintf(msg, sizeof(msg), "TEST_RESULT_READY");
-		psoc4_send_nl_msg(msg);
 		// Add specific handling for Test Result Ready
 	}
 	if (int_status & INT_STATUS_SENSING_RUNNING) {
 		dev_dbg(&client->dev, "Sensing App Running interrupt\n");
-		snprintf(msg, sizeof(msg), "SENSING_RUNNING");
-		psoc4_send_nl_msg(msg);
 		// Add specific handling for Sensing App Running
 	}
 	if (int_status & INT_STATUS_GEST_DETECTED) {
 		dev_dbg(&client->dev, "Gesture Detected interrupt\n");
-		snprintf(msg, sizeof(msg), "GESTURE_DETECTED");
-		psoc4_send_nl_msg(msg);
-		ret = psoc4_gesture_detected_handler(client);
+		ret = psoc4_gesture_detected_handler(client, frame);
 		if (ret < 0)
-			return IRQ_NONE; // No gestures detected, exit early
+			return ret; // No gestures detected, exit early
 	}
 	if (int_status & INT_STATUS_LIFTOFF_TCHDWN) {
 		dev_dbg(&client->dev, "Liftoff/Touchdown Detected interrupt\n");
-		snprintf(msg, sizeof(msg), "LIFTOFF_TOUCHDOWN_DETECTED");
-		psoc4_send_nl_msg(msg);
 #if defined(TOUCHDOWN_LIFTOFF_ON_IRQ)
-		ret = psoc4_liftoff_touchdown_handler(client);
+		ret = psoc4_liftoff_touchdown_handler(client, frame);
 		if (ret < 0)
-			return IRQ_NONE; // No liftoff/touchdown event handled, exit early
+			return ret; // No liftoff/touchdown event handled, exit early
 #endif /* #if defined(TOUCHDOWN_LIFTOFF_ON_IRQ) */
 	}
 	if (int_status & INT_STATUS_APP_ERROR) {
 		dev_err(&client->dev, "PSOC4 FW application Error interrupt\n");
-		snprintf(msg, sizeof(msg), "APP_ERROR");
-		psoc4_send_nl_msg(msg);
 		// Add specific handling for Application Error
 	}
 
-	// Clear all pending interrupts by writing 0x00 to the INT_STATUS register
-	ret = psoc4_irq_clear(client);
+	// Notify user space once the frame data is complete, sent by the netlink worker
+	psoc4_nl_queue_event(client, frame);
 
-	return IRQ_HANDLED;
+	return 0;
 }
 
-int psoc4_irq_register(struct i2c_client *client)
+// Start polling frames at the active scan rate
+// Called with the event lock held. In hybrid mode the touch interrupt source
+// is masked while polling.
+static void psoc4_poll_start(struct i2c_client *client, bool mask_touch)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	u8 rate;
 	int ret;
+
+	ret = psoc4_read_register(client, REG_SNS_REF_RATE_ACT, &rate, REG_SNS_REF_RATE_ACT_SIZE);
+	if (ret < 0 || rate == 0)
+		rate = POLL_DEFAULT_RATE_HZ;
+	data->poll_period = NSEC_PER_SEC / rate;
+
+	if (mask_touch) {
+		ret = psoc4_update_register(client, REG_INT_SRC_EN, INT_STATUS_TOUCH_DETECTED, 0);
+		if (ret < 0) {
+			dev_warn(&client->dev, "Failed to mask touch interrupt, staying in IRQ mode\n");
+			return;
+		}
+	}
+
+	dev_dbg(&client->dev, "Polling frames every %llu ns\n", data->poll_period);
+	data->polling = true;
+	data->poll_next = ktime_add_ns(ktime_get(), data->poll_period);
+	hrtimer_start(&data->poll_timer, data->poll_next, HRTIMER_MODE_ABS);
+}
+
+// Stop polling, waits for a running poll to finish
+void psoc4_poll_stop(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	mutex_lock(&data->event_lock);
+	data->polling = false;
+	mutex_unlock(&data->event_lock);
+
+	hrtimer_cancel(&data->poll_timer);
+	cancel_work_sync(&data->poll_work);
+}
+
+// Poll timer, the frame is read from the high priority workqueue
+static enum hrtimer_restart psoc4_poll_timer(struct hrtimer *timer)
+{
+	struct psoc4_data *data = container_of(timer, struct psoc4_data, poll_timer);
+
+	data->poll_time = ktime_get();
+	queue_work(system_highpri_wq, &data->poll_work);
+
+	return HRTIMER_NORESTART;
+}
+
+// Poll work, reads and handles one frame
+static void psoc4_poll_work(struct work_struct *work)
+{
+	struct psoc4_data *data = container_of(work, struct psoc4_data, poll_work);
+	struct i2c_client *client = data->client;
+	struct psoc4_frame frame = { 0 };
+	ktime_t now;
+	int ret;
+
+	mutex_lock(&data->event_lock);
+	if (!data->polling)
+		goto unlock;
+
+	data->event_time = data->poll_time;
+
+	ret = psoc4_read_frame(client, &frame);
+	if (ret == 0) {
+		// Touches are sampled on every poll, including the liftoff frame
+		if (frame.num_touches > 0 || data->poll_touching)
+			frame.int_status |= INT_STATUS_TOUCH_DETECTED;
+		data->poll_touching = frame.num_touches > 0;
+
+		if (psoc4_process_events(client, &frame) == 0)
+			psoc4_irq_ack(client, frame.int_status);
+
+		if (!data->poll_only && frame.num_touches == 0) {
+			// Liftoff, return to interrupt mode
+			dev_dbg(&client->dev, "Liftoff, back to IRQ mode\n");
+			data->polling = false;
+			psoc4_update_register(client, REG_INT_SRC_EN, INT_STATUS_TOUCH_DETECTED,
+									INT_STATUS_TOUCH_DETECTED);
+			goto unlock;
+		}
+	}
+
+	// Stay locked to the scan period, skip periods missed by a slow poll
+	now = ktime_get();
+	data->poll_next = ktime_add_ns(data->poll_next, data->poll_period);
+	if (ktime_before(data->poll_next, now))
+		data->poll_next = ktime_add_ns(now, data->poll_period);
+	hrtimer_start(&data->poll_timer, data->poll_next, HRTIMER_MODE_ABS);
+
+unlock:
+	mutex_unlock(&data->event_lock);
+}
+
+// Interrupt handler
+// Drains INT_STATUS: events raised while a frame is handled are picked up by
+// the next iteration instead of waiting for another edge.
+static irqreturn_t psoc4_irq_handler(int irq, void *dev_id)
+{
+	struct i2c_client *client = dev_id;
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_frame frame;
+	irqreturn_t irq_ret = IRQ_NONE;
+	unsigned int budget;
+	ktime_t start;
+	int ret;
+
+	mutex_lock(&data->event_lock);
+	start = ktime_get();
+
+	for (budget = IRQ_DRAIN_BUDGET; budget > 0; budget--) {
+		memset(&frame, 0, sizeof(frame));
+
+		// The first frame belongs to the edge, later ones were raised meanwhile
+		data->event_time = irq_ret == IRQ_NONE ? data->irq_time : ktime_get();
+
+#if defined(IRQ_FRAME_READ)
+		// Read the INT_STATUS register together with the touch report block
+		ret = psoc4_read_frame(client, &frame);
+#else
+		// Read the INT_STATUS register
+		ret = psoc4_read_register(client, REG_INT_STATUS, &frame.int_status,
+									REG_INT_STATUS_SIZE);
+#endif /* #if defined(IRQ_FRAME_READ) */
+		if (ret < 0) {
+			dev_err(&client->dev, "Failed to read INT_STATUS register\n");
+			psoc4_irq_clear(client);
+			goto unlock;
+		}
+
+		if (frame.int_status == INT_STATUS_NO_PENDING)
+			break;
+
+		ret = psoc4_process_events(client, &frame);
+		if (ret < 0)
+			goto unlock;
+
+		psoc4_irq_ack(client, frame.int_status);
+		irq_ret = IRQ_HANDLED;
+
+#if defined(HYBRID_POLLING)
+		// Touchdown, poll the frames while the finger stays down
+		if (!data->polling && frame.num_touches > 0) {
+			dev_dbg(&client->dev, "Touchdown, switching to polling\n");
+			data->poll_touching = true;
+			psoc4_poll_start(client, true);
+		}
+#endif /* #if defined(HYBRID_POLLING) */
+	}
+
+	if (!budget)
+		dev_dbg(&client->dev, "IRQ drain budget exhausted, events still pending\n");
+
+unlock:
+	psoc4_irq_account_time(data, ktime_sub(ktime_get(), start));
+	mutex_unlock(&data->event_lock);
+	return irq_ret;
+}
+
+int psoc4_irq_register(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
 	struct device_node *node = client->dev.of_node;
+	unsigned long irq_flags;
+	int ret;
 
-	// Netlink init
-	ret = psoc4_nl_init();
-	if (ret)
-		return ret;
+	hrtimer_init(&data->poll_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	data->poll_timer.function = psoc4_poll_timer;
+	INIT_WORK(&data->poll_work, psoc4_poll_work);
 
 	// Get the interrupt number from the device tree
-	irq_number = of_irq_get(node, 0);
-	if (irq_number < 0) {
-		dev_err(&client->dev, "Failed to get IRQ number from device tree\n");
-		psoc4_nl_exit();
-		return irq_number;
+	data->irq = of_irq_get(node, 0);
+	if (data->irq == -EPROBE_DEFER)
+		return data->irq;
+
+	// Without an interrupt the frames are polled at the active scan rate
+	if (data->irq <= 0) {
+		dev_info(&client->dev, "No IRQ in device tree, polling PSOC4 FW\n");
+		data->irq = 0;
+		data->poll_only = true;
+		mutex_lock(&data->event_lock);
+		psoc4_poll_start(client, false);
+		mutex_unlock(&data->event_lock);
+		return 0;
 	}
 
-	// Request the interrupt
-	ret = devm_request_threaded_irq(&client->dev, irq_number, NULL, psoc4_irq_handler,
-					IRQF_TRIGGER_FALLING | IRQF_ONESHOT, "psoc4_irq", client);
-	if (ret) {
-		psoc4_nl_exit();
+	// Use the trigger type from the device tree, falling edge by default
+	irq_flags = irq_get_trigger_type(data->irq);
+	if (irq_flags == IRQ_TYPE_NONE)
+		irq_flags = IRQF_TRIGGER_FALLING;
+
+	// Request the interrupt, every device gets its own IRQ thread
+	ret = devm_request_threaded_irq(&client->dev, data->irq, psoc4_irq_hardirq,
+					psoc4_irq_handler, irq_flags | IRQF_ONESHOT,
+					dev_name(&client->dev), client);
+	if (ret)
 		return ret;
-	}
 
-	dev_info(&client->dev, "Requested IRQ %d for PSOC4 FW\n", irq_number);
+	dev_info(&client->dev, "Requested IRQ %d for PSOC4 FW\n", data->irq);
 	return 0;
 }
-// Netlink cleanup should be called from module exit, not sysfs_remove
 
 int psoc4_irq_clear(struct i2c_client *client)
 {
 	int ret;
 	u8 int_status = INT_STATUS_CLEAR_PENDING;
+	ktime_t deadline = ktime_add_ms(ktime_get(), IRQ_CLEAR_TIMEOUT_MS);
 
 	// Clear all pending interrupts by writing 0x00 to the INT_STATUS register
-	// TODO: Review this approach, as it may not be the best way to clear interrupts
+	// Every write already retries with backoff, give up once the deadline expired
 	do {
 		ret = psoc4_write_register(client, REG_INT_STATUS, &int_status,
 									REG_INT_STATUS_SIZE);
-	} while (ret < 0);
+		if (ret == 0)
+			return 0;
+	} while (ktime_before(ktime_get(), deadline));
 
-	return 0;
+	dev_err(&client->dev, "Failed to clear pending interrupts: %d\n", ret);
+	return ret;
+}
+
+// Enable the scan complete interrupt source for one more user
+// The sensor capture stream and the IIO trigger share the source. Its
+// previous state is saved by the first user and restored by the last one.
+int psoc4_scan_irq_get(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	u8 int_src_en;
+	int ret = 0;
+
+	mutex_lock(&data->event_lock);
+	if (data->scan_irq_users == 0) {
+		ret = psoc4_read_register(client, REG_INT_SRC_EN, &int_src_en,
+									REG_INT_SRC_EN_SIZE);
+		if (ret < 0)
+			goto unlock;
+		data->scan_irq_saved = int_src_en & INT_STATUS_SCAN_COMPLETE;
+
+		ret = psoc4_update_register(client, REG_INT_SRC_EN, INT_STATUS_SCAN_COMPLETE,
+									INT_STATUS_SCAN_COMPLETE);
+		if (ret < 0) {
+			dev_err(&client->dev, "Failed to enable scan complete interrupt\n");
+			goto unlock;
+		}
+	}
+	data->scan_irq_users++;
+
+unlock:
+	mutex_unlock(&data->event_lock);
+	return ret;
 }
 
-int psoc4_touch_detected_handler(struct i2c_client *client)
+// Drop a user of the scan complete interrupt source
+void psoc4_scan_irq_put(struct i2c_client *client)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
 	int ret;
-	struct psoc4_touch touches[NUM_TOUCH_SLOTS];
-	u8 num_touches;
 
-	ret = psoc4_read_register(client, REG_NUM_TOUCH, &num_touches, REG_NUM_TOUCH_SIZE);
+	mutex_lock(&data->event_lock);
+	if (data->scan_irq_users && !--data->scan_irq_users) {
+		ret = psoc4_update_register(client, REG_INT_SRC_EN, INT_STATUS_SCAN_COMPLETE,
+									data->scan_irq_saved);
+		if (ret < 0)
+			dev_err(&client->dev, "Failed to restore INT_SRC_EN register\n");
+	}
+	mutex_unlock(&data->event_lock);
+}
+
+#if !defined(IRQ_FRAME_READ)
+// Read NUM_TOUCH and the coordinates of the reported touches
+static int psoc4_read_touches(struct i2c_client *client, struct psoc4_frame *frame)
+{
+	int ret;
+
+	ret = psoc4_read_register(client, REG_NUM_TOUCH, &frame->num_touches, REG_NUM_TOUCH_SIZE);
 	if (ret < 0) {
 		dev_err(&client->dev, "Failed to read number of touches\n");
-		psoc4_irq_clear(client);
 		return ret;
 	}
-	dev_dbg(&client->dev, "Number of touches detected: %u\n", num_touches);
-
-	if (num_touches > NUM_TOUCH_SLOTS) { // We only support up to 2 touches
-		dev_warn(&client->dev, "Unexpected number of touches: %u\n", num_touches);
-		psoc4_irq_clear(client);
-		return -EINVAL;
-	}
-
-	for (unsigned int slot = 0; slot < num_touches; slot++) {
-		dev_dbg(&client->dev, "TCH%u detected\n", slot);
 
+	for (unsigned int slot = 0; slot < min_t(u8, frame->num_touches, NUM_TOUCH_SLOTS); slot++) {
 		ret = psoc4_read_xyz_coords(client, REG_TCH0_POS + (slot * REG_TCH_XYZ_SIZE_BYTES),
-									&touches[slot].x,
-									&touches[slot].y,
-									&touches[slot].z);
-
+									&frame->touches[slot].x,
+									&frame->touches[slot].y,
+									&frame->touches[slot].z);
 		if (ret < 0) {
 			dev_err(&client->dev, "Failed to read TCH%u coordinates\n", slot);
-			psoc4_irq_clear(client);
 			return ret;
 		}
+	}
 
-		dev_dbg(&client->dev, "TCH%u coordinates: X=%u, Y=%u, Z=%u\n",
-				slot, touches[slot].x, touches[slot].y, touches[slot].z);
+	return 0;
+}
+#endif /* #if !defined(IRQ_FRAME_READ) */
+
+int psoc4_touch_detected_handler(struct i2c_client *client, struct psoc4_frame *frame)
+{
+#if !defined(IRQ_FRAME_READ)
+	int ret;
+
+	ret = psoc4_read_touches(client, frame);
+	if (ret < 0) {
+		psoc4_irq_clear(client);
+		return ret;
+	}
+#endif /* #if !defined(IRQ_FRAME_READ) */
+	dev_dbg(&client->dev, "Number of touches detected: %u\n", frame->num_touches);
+
+	if (frame->num_touches > NUM_TOUCH_SLOTS) { // We only support up to 2 touches
+		dev_warn(&client->dev, "Unexpected number of touches: %u\n", frame->num_touches);
+		psoc4_irq_clear(client);
+		return -EINVAL;
 	}
 
-	psoc4_input_report_coord(client, num_touches, touches); // Report touches to input subsystem
+	for (unsigned int slot = 0; slot < frame->num_touches; slot++)
+		dev_dbg(&client->dev, "TCH%u coordinates: X=%u, Y=%u, Z=%u\n", slot,
+				frame->touches[slot].x, frame->touches[slot].y, frame->touches[slot].z);
+
+	// Report touches to input subsystem
+	psoc4_input_report_coord(client, frame->num_touches, frame->touches);
+
+	// Add the frame to the /dev/psoc4-N ring
+	psoc4_ring_push(client, frame);
 	return 0;
 }
 
-int psoc4_gesture_detected_handler(struct i2c_client *client)
+int psoc4_gesture_detected_handler(struct i2c_client *client, struct psoc4_frame *frame)
 {
+#if !defined(IRQ_FRAME_READ)
 	int ret;
-	u32 gestures;
 
-	ret = psoc4_read_gestures(client, &gestures);
+	ret = psoc4_read_gestures(client, &frame->gestures);
 	if (ret < 0) {
 		dev_err(&client->dev, "Failed to read gestures\n");
 		psoc4_irq_clear(client);
 		return ret;
 	}
+#endif /* #if !defined(IRQ_FRAME_READ) */
 
-	dev_info(&client->dev, "Gestures detected: 0x%08x\n", gestures);
+	dev_info(&client->dev, "Gestures detected: 0x%08x\n", frame->gestures);
 
-	psoc4_input_report_gesture(client, gestures); // Report gestures to input subsystem
+	psoc4_input_report_gesture(client, frame->gestures); // Report gestures to input subsystem
 	return 0;
 }
 
-int psoc4_liftoff_touchdown_handler(struct i2c_client *client)
+int psoc4_liftoff_touchdown_handler(struct i2c_client *client, struct psoc4_frame *frame)
 {
+#if !defined(IRQ_FRAME_READ)
 	int ret;
 
-	u8 num_touches;
-
-	ret = psoc4_read_register(client, REG_NUM_TOUCH, &num_touches, REG_NUM_TOUCH_SIZE);
+	ret = psoc4_read_register(client, REG_NUM_TOUCH, &frame->num_touches, REG_NUM_TOUCH_SIZE);
 	if (ret < 0) {
 		dev_err(&client->dev, "Failed to read number of touches\n");
 		psoc4_irq_clear(client);
 		return ret;
 	}
-	dev_dbg(&client->dev, "Number of touches detected: %u\n", num_touches);
+#endif /* #if !defined(IRQ_FRAME_READ) */
+	dev_dbg(&client->dev, "Number of touches detected: %u\n", frame->num_touches);
 
 	// Report liftoff/touchdown to input subsystem
-	psoc4_input_report_liftoff_touchdown(client, num_touches);
+	psoc4_input_report_liftoff_touchdown(client, frame->num_touches);
 	return 0;
 }
@@ -46,32 +46,27 @@
  */
 
 #include "i2c-psoc4-driver.h"
+#include "cybootloaderutils/cybtldr_command.h"
 
 #if defined(TOUCHDOWN_LIFTOFF_ON_GESTURE) && defined(TOUCHDOWN_LIFTOFF_ON_IRQ)
 #error "Only one of TOUCHDOWN_LIFTOFF_ON_GESTURE or TOUCHDOWN_LIFTOFF_ON_IRQ can be defined at a time!"
 #endif
 
+// Device numbers, reported in netlink events
+static DEFINE_IDA(psoc4_ida);
+
 int init_psoc4_config(struct i2c_client *client)
 {
 	int ret;
-	u8 int_src_en;
 
 	// Initial config for this register
-	// Read REG_INT_SRC_EN
-	ret = psoc4_read_register(client, REG_INT_SRC_EN, &int_src_en, REG_INT_SRC_EN_SIZE);
+	// Clear bit 0 (scan complete) in REG_INT_SRC_EN
+	ret = psoc4_update_register(client, REG_INT_SRC_EN, INT_STATUS_SCAN_COMPLETE, 0);
 	if (ret < 0) {
-		dev_err(&client->dev, "Failed to read INT_SRC_EN register\n");
+		dev_err(&client->dev, "Failed to update INT_SRC_EN register\n");
 		return ret;
 	}
-	// Clear bit 0 in REG_INT_SRC_EN
-	int_src_en &= ~0x01;
-	// Write back to REG_INT_SRC_EN
-	ret = psoc4_write_register(client, REG_INT_SRC_EN, &int_src_en, REG_INT_SRC_EN_SIZE);
-	if (ret < 0) {
-		dev_err(&client->dev, "Failed to write INT_SRC_EN register\n");
-		return ret;
-	}
-	dev_dbg(&client->dev, "Updated INT_SRC_EN register: 0x%02x\n", int_src_en);
+	dev_dbg(&client->dev, "Disabled scan complete interrupt source\n");
 
 	psoc4_irq_clear(client);
 	return 0;
@@ -80,50 +75,117 @@ int init_psoc4_config(struct i2c_client *client)
 // Probe function
 static int psoc4_i2c_probe(struct i2c_client *client)
 {
+	struct psoc4_data *data;
+	u8 num_sns;
 	int ret;
 
 	dev_info(&client->dev, "Probed device with address 0x%02x\n", client->addr);
 
+	data = devm_kzalloc(&client->dev, sizeof(*data), GFP_KERNEL);
+	if (!data)
+		return -ENOMEM;
+
+	data->client = client;
+	data->id = ida_alloc(&psoc4_ida, GFP_KERNEL);
+	if (data->id < 0)
+		return data->id;
+	mutex_init(&data->lock);
+	mutex_init(&data->event_lock);
+	mutex_init(&data->sns_lock);
+	psoc4_retry_policy_init(&data->retry_policy);
+	i2c_set_clientdata(client, data);
+	psoc4_nl_dev_init(client);
+
+	ret = psoc4_regmap_init(client);
+	if (ret)
+		goto free_id;
+
+	psoc4_dfu_init(client);
+
 	ret = init_psoc4_config(client);
 	if (ret) {
 		dev_err(&client->dev, "Failed to initialize PSOC4 configuration\n");
-		return ret;
+		goto free_id;
+	}
+
+	// NUM_SNS is cached from now on, until the next reset, restore or DFU
+	ret = psoc4_read_num_sns(client, &num_sns);
+	if (ret) {
+		dev_err(&client->dev, "Failed to read number of sensors\n");
+		goto free_id;
 	}
+	dev_dbg(&client->dev, "%u sensors\n", num_sns);
 
 	ret = psoc4_sysfs_create(client);
 	if (ret) {
 		dev_err(&client->dev, "Failed to create sysfs entries\n");
-		return ret;
+		goto free_id;
 	}
 
 	ret = psoc4_debugfs_create(client);
 	if (ret) {
 		dev_err(&client->dev, "Failed to create debugfs entries\n");
-		return ret;
+		goto remove_sysfs;
 	}
 
 	ret = psoc4_input_dev_create(client);
 	if (ret) {
 		dev_err(&client->dev, "Failed to register input device\n");
-		return ret;
+		goto remove_debugfs;
+	}
+
+	ret = psoc4_ring_create(client);
+	if (ret) {
+		dev_err(&client->dev, "Failed to create frame ring device\n");
+		goto remove_debugfs;
+	}
+
+	ret = psoc4_iio_create(client);
+	if (ret) {
+		dev_err(&client->dev, "Failed to register IIO device\n");
+		goto remove_ring;
 	}
 
+	// Falls back to polling if the device tree has no interrupt
 	ret = psoc4_irq_register(client);
 	if (ret) {
 		dev_err(&client->dev, "Failed to request IRQ\n");
-		return ret;
+		goto remove_iio;
 	}
 
+	psoc4_nl_dev_add(client);
 	return 0;
+
+remove_iio:
+	psoc4_iio_remove(client);
+remove_ring:
+	psoc4_ring_remove(client);
+remove_debugfs:
+	psoc4_debugfs_remove(client);
+remove_sysfs:
+	psoc4_sysfs_remove(client);
+free_id:
+	ida_free(&psoc4_ida, data->id);
+	return ret;
 }
 
 // Remove function
 static void psoc4_i2c_remove(struct i2c_client *client)
 {
-	psoc4_nl_exit();
-	psoc4_debugfs_remove();
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	// The IRQ is released by devres after remove, stop the handler first
+	if (data->irq > 0)
+		disable_irq(data->irq);
+	psoc4_poll_stop(client);
+	psoc4_nl_dev_remove(client);
+	psoc4_ring_remove(client);
+	psoc4_iio_remove(client);
+
+	psoc4_debugfs_remove(client);
 	psoc4_sysfs_remove(client);
 	psoc4_input_dev_remove(client);
+	ida_free(&psoc4_ida, data->id);
 
 	dev_info(&client->dev, "Removed device with address 0x%02x\n", client->addr);
 }
@@ -145,8 +207,33 @@ static struct i2c_driver psoc4_i2c_driver = {
 	.remove = psoc4_i2c_remove,
 };
 
-// Register the I2C driver
-module_i2c_driver(psoc4_i2c_driver);
+// The netlink family must exist before the first device is probed
+static int __init psoc4_init(void)
+{
+	int ret;
+
+	CyBtldr_InitChecksum();
+
+	ret = psoc4_nl_init();
+	if (ret)
+		return ret;
+
+	// Register the I2C driver
+	ret = i2c_add_driver(&psoc4_i2c_driver);
+	if (ret)
+		psoc4_nl_exit();
+
+	return ret;
+}
+
+static void __exit psoc4_exit(void)
+{
+	i2c_del_driver(&psoc4_i2c_driver);
+	psoc4_nl_exit();
+}
+
+module_init(psoc4_init);
+module_exit(psoc4_exit);
 
 // Metadata for the module
 MODULE_LICENSE("Dual MIT/GPL");
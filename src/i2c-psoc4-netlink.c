@@ -0,0 +1,696 @@
+// SPDX-License-Identifier: GPL-2.0 OR MIT
+/*
+ * Copyright (C) 2025, Infineon Technologies AG, or an affiliate of Infineon Technologies AG.
+ * All rights reserved.
+ *
+ * Licensed under either of
+ *
+ * GNU General Public License, Version 2.0 <https://www.gnu.org/licenses/gpl-2.0.html>
+ * MIT license  <http://opensource.org/licenses/MIT>
+ *
+ * at your option.
+ *
+ * When Licensed under the GNU General Public License, Version 2.0 (the "License");
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/gpl-2.0.html>
+ *
+ * When licensed under the MIT license;
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the “Software”), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "i2c-psoc4-driver.h"
+
+static const struct genl_multicast_group psoc4_genl_mcgrps[] = {
+	[PSOC4_GENL_MCGRP_EVENTS] = { .name = PSOC4_GENL_MCGRP_EVENTS_NAME },
+	[PSOC4_GENL_MCGRP_TOUCH] = { .name = PSOC4_GENL_MCGRP_TOUCH_NAME },
+	[PSOC4_GENL_MCGRP_GESTURE] = { .name = PSOC4_GENL_MCGRP_GESTURE_NAME },
+	[PSOC4_GENL_MCGRP_LIFTOFF_TOUCHDOWN] = { .name = PSOC4_GENL_MCGRP_LIFTOFF_TOUCHDOWN_NAME },
+	[PSOC4_GENL_MCGRP_SCAN] = { .name = PSOC4_GENL_MCGRP_SCAN_NAME },
+	[PSOC4_GENL_MCGRP_TEST] = { .name = PSOC4_GENL_MCGRP_TEST_NAME },
+	[PSOC4_GENL_MCGRP_ERROR] = { .name = PSOC4_GENL_MCGRP_ERROR_NAME },
+};
+
+// INT_STATUS bits delivered to each multicast group
+static const u8 psoc4_nl_group_status[] = {
+	[PSOC4_GENL_MCGRP_EVENTS] = 0xFF,
+	[PSOC4_GENL_MCGRP_TOUCH] = INT_STATUS_TOUCH_DETECTED,
+	[PSOC4_GENL_MCGRP_GESTURE] = INT_STATUS_GEST_DETECTED,
+	[PSOC4_GENL_MCGRP_LIFTOFF_TOUCHDOWN] = INT_STATUS_LIFTOFF_TCHDWN,
+	[PSOC4_GENL_MCGRP_SCAN] = INT_STATUS_SCAN_COMPLETE,
+	[PSOC4_GENL_MCGRP_TEST] = INT_STATUS_TEST_RESULT_READY,
+	[PSOC4_GENL_MCGRP_ERROR] = INT_STATUS_APP_ERROR,
+};
+static_assert(ARRAY_SIZE(psoc4_nl_group_status) == ARRAY_SIZE(psoc4_genl_mcgrps));
+
+static struct genl_family psoc4_genl_family;
+
+// Devices that accept configuration requests
+static DEFINE_MUTEX(psoc4_nl_devices_lock);
+static LIST_HEAD(psoc4_nl_devices);
+
+// Number of subscriptions per multicast group, for diagnostics
+static atomic_t psoc4_nl_subscriptions[ARRAY_SIZE(psoc4_genl_mcgrps)];
+
+static int psoc4_nl_bind(int group)
+{
+	if (group < 0 || group >= ARRAY_SIZE(psoc4_genl_mcgrps))
+		return 0;
+
+	pr_debug("Netlink: Listener joined group %s\n", psoc4_genl_mcgrps[group].name);
+	atomic_inc(&psoc4_nl_subscriptions[group]);
+	return 0;
+}
+
+static void psoc4_nl_unbind(int group)
+{
+	if (group < 0 || group >= ARRAY_SIZE(psoc4_genl_mcgrps))
+		return;
+
+	pr_debug("Netlink: Listener left group %s\n", psoc4_genl_mcgrps[group].name);
+	// Dropping a group that was never joined also ends up here
+	atomic_dec_if_positive(&psoc4_nl_subscriptions[group]);
+}
+
+// Check whether a multicast group has listeners
+// Costs a bit test, so events are only built for groups somebody listens to.
+static bool psoc4_nl_has_listeners(unsigned int group)
+{
+	return genl_has_listeners(&psoc4_genl_family, &init_net, group);
+}
+
+// Print the number of subscriptions of each multicast group
+void psoc4_nl_show_subscriptions(struct seq_file *s)
+{
+	for (unsigned int group = 0; group < ARRAY_SIZE(psoc4_genl_mcgrps); group++)
+		seq_printf(s, "%s %d\n", psoc4_genl_mcgrps[group].name,
+					atomic_read(&psoc4_nl_subscriptions[group]));
+}
+
+// Size of an event message with the given INT_STATUS bits
+static size_t psoc4_nl_event_size(struct i2c_client *client, u8 int_status)
+{
+	size_t touch_size = nla_total_size(nla_total_size(sizeof(u8)) +
+										3 * nla_total_size(sizeof(u16)));
+	size_t size;
+
+	size = nla_total_size(sizeof(u32)) +				// PSOC4_ATTR_DEV_ID
+		nla_total_size(strlen(dev_name(&client->dev)) + 1) +	// PSOC4_ATTR_DEV_NAME
+		nla_total_size(sizeof(u32)) +				// PSOC4_ATTR_SEQ
+		nla_total_size_64bit(sizeof(s64)) +			// PSOC4_ATTR_TIMESTAMP
+		nla_total_size(sizeof(u8));				// PSOC4_ATTR_INT_STATUS
+
+	if (int_status & INT_STATUS_TOUCH_DETECTED)
+		size += nla_total_size(sizeof(u8)) +			// PSOC4_ATTR_NUM_TOUCH
+			nla_total_size(NUM_TOUCH_SLOTS * touch_size);	// PSOC4_ATTR_TOUCHES
+	if (int_status & INT_STATUS_GEST_DETECTED)
+		size += nla_total_size(sizeof(u32));			// PSOC4_ATTR_GESTURES
+
+	return size;
+}
+
+// Put the touches of a frame as nested attributes
+static int psoc4_nl_put_touches(struct sk_buff *skb, struct psoc4_frame *frame)
+{
+	struct nlattr *touches, *touch;
+	u8 num_touches = min_t(u8, frame->num_touches, NUM_TOUCH_SLOTS);
+
+	if (nla_put_u8(skb, PSOC4_ATTR_NUM_TOUCH, frame->num_touches))
+		return -EMSGSIZE;
+
+	touches = nla_nest_start(skb, PSOC4_ATTR_TOUCHES);
+	if (!touches)
+		return -EMSGSIZE;
+
+	for (u8 slot = 0; slot < num_touches; slot++) {
+		touch = nla_nest_start(skb, PSOC4_ATTR_TOUCH);
+		if (!touch ||
+			nla_put_u8(skb, PSOC4_TOUCH_ATTR_SLOT, slot) ||
+			nla_put_u16(skb, PSOC4_TOUCH_ATTR_X, frame->touches[slot].x) ||
+			nla_put_u16(skb, PSOC4_TOUCH_ATTR_Y, frame->touches[slot].y) ||
+			nla_put_u16(skb, PSOC4_TOUCH_ATTR_Z, frame->touches[slot].z))
+			return -EMSGSIZE;
+		nla_nest_end(skb, touch);
+	}
+
+	nla_nest_end(skb, touches);
+	return 0;
+}
+
+// Put the message of a queued event into an skb
+// Only the INT_STATUS bits of the group and their data are included.
+static int psoc4_nl_put_event(struct sk_buff *skb, struct i2c_client *client,
+								struct psoc4_nl_event *event, u8 int_status, int flags)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_frame *frame = &event->frame;
+	void *hdr;
+
+	hdr = genlmsg_put(skb, 0, 0, &psoc4_genl_family, flags, PSOC4_CMD_EVENT);
+	if (!hdr)
+		return -EMSGSIZE;
+
+	if (nla_put_u32(skb, PSOC4_ATTR_DEV_ID, data->id) ||
+		nla_put_string(skb, PSOC4_ATTR_DEV_NAME, dev_name(&client->dev)) ||
+		nla_put_u32(skb, PSOC4_ATTR_SEQ, event->seq) ||
+		nla_put_s64(skb, PSOC4_ATTR_TIMESTAMP, ktime_to_ns(event->time),
+					PSOC4_ATTR_PAD) ||
+		nla_put_u8(skb, PSOC4_ATTR_INT_STATUS, int_status))
+		goto nla_put_failure;
+
+	if ((int_status & INT_STATUS_TOUCH_DETECTED) &&
+		psoc4_nl_put_touches(skb, frame))
+		goto nla_put_failure;
+
+	if ((int_status & INT_STATUS_GEST_DETECTED) &&
+		nla_put_u32(skb, PSOC4_ATTR_GESTURES, frame->gestures))
+		goto nla_put_failure;
+
+	genlmsg_end(skb, hdr);
+	return 0;
+
+nla_put_failure:
+	genlmsg_cancel(skb, hdr);
+	return -EMSGSIZE;
+}
+
+// Multicast an skb to a group
+static void psoc4_nl_multicast(struct i2c_client *client, struct sk_buff *skb,
+								unsigned int group)
+{
+	int ret;
+
+	ret = genlmsg_multicast(&psoc4_genl_family, skb, 0, group, GFP_KERNEL);
+	if (ret < 0 && ret != -ESRCH)
+		dev_err(&client->dev, "Netlink: multicast send failed: %d\n", ret);
+}
+
+// Terminate and send the coalesced events of a group
+// Called with the netlink lock held
+static void psoc4_nl_flush_group_locked(struct i2c_client *client, unsigned int group)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct sk_buff *skb = data->nl_batch[group];
+
+	if (!skb)
+		return;
+	data->nl_batch[group] = NULL;
+
+	// Room for NLMSG_DONE is reserved when events are added
+	if (!nlmsg_put(skb, 0, 0, NLMSG_DONE, 0, NLM_F_MULTI)) {
+		dev_err(&client->dev, "Netlink: Failed to terminate event batch\n");
+		nlmsg_free(skb);
+		return;
+	}
+
+	psoc4_nl_multicast(client, skb, group);
+}
+
+// Send the coalesced events of all groups
+// Called with the netlink lock held
+static void psoc4_nl_flush_locked(struct i2c_client *client)
+{
+	for (unsigned int group = 0; group < ARRAY_SIZE(psoc4_genl_mcgrps); group++)
+		psoc4_nl_flush_group_locked(client, group);
+}
+
+// Coalescing window expired, send the collected events
+static void psoc4_nl_flush_work(struct work_struct *work)
+{
+	struct psoc4_data *data = container_of(to_delayed_work(work), struct psoc4_data,
+											nl_flush_work);
+
+	mutex_lock(&data->nl_lock);
+	psoc4_nl_flush_locked(data->client);
+	mutex_unlock(&data->nl_lock);
+}
+
+// Add an event to the coalesced batch of a group, a new batch opens the window
+// Called with the netlink lock held
+static int psoc4_nl_batch_event(struct i2c_client *client, struct psoc4_nl_event *event,
+								unsigned int group, u8 int_status, size_t size)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	size_t room = nlmsg_total_size(GENL_HDRLEN + size) + nlmsg_total_size(0);
+
+	// Send a full batch early rather than splitting an event
+	if (data->nl_batch[group] && skb_tailroom(data->nl_batch[group]) < room)
+		psoc4_nl_flush_group_locked(client, group);
+
+	if (!data->nl_batch[group]) {
+		data->nl_batch[group] = nlmsg_new(max_t(size_t, NLMSG_GOODSIZE, room), GFP_KERNEL);
+		if (!data->nl_batch[group])
+			return -ENOMEM;
+		// The window is shared by all groups, the first event of any group opens it
+		queue_delayed_work(system_wq, &data->nl_flush_work,
+							msecs_to_jiffies(data->nl_coalesce_ms));
+	}
+
+	return psoc4_nl_put_event(data->nl_batch[group], client, event, int_status,
+								NLM_F_MULTI);
+}
+
+// Send a queued event to a multicast group
+// With a coalescing window the events are collected into one multi-part message.
+static void psoc4_nl_emit(struct i2c_client *client, struct psoc4_nl_event *event,
+							unsigned int group)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	u8 int_status = event->frame.int_status & psoc4_nl_group_status[group];
+	struct sk_buff *skb;
+	size_t size;
+	int ret;
+
+	size = psoc4_nl_event_size(client, int_status);
+
+	mutex_lock(&data->nl_lock);
+	if (data->nl_coalesce_ms) {
+		ret = psoc4_nl_batch_event(client, event, group, int_status, size);
+		mutex_unlock(&data->nl_lock);
+		if (ret < 0)
+			dev_err(&client->dev, "Netlink: Failed to batch event: %d\n", ret);
+		return;
+	}
+	mutex_unlock(&data->nl_lock);
+
+	skb = genlmsg_new(size, GFP_KERNEL);
+	if (!skb) {
+		dev_err(&client->dev, "Netlink: Failed to allocate skb\n");
+		return;
+	}
+
+	if (psoc4_nl_put_event(skb, client, event, int_status, 0)) {
+		dev_err(&client->dev, "Netlink: Failed to build event message\n");
+		nlmsg_free(skb);
+		return;
+	}
+
+	psoc4_nl_multicast(client, skb, group);
+}
+
+// Netlink worker, sends the events queued by the event path
+static void psoc4_nl_work(struct work_struct *work)
+{
+	struct psoc4_data *data = container_of(work, struct psoc4_data, nl_work);
+	struct psoc4_nl_event event;
+	unsigned long groups;
+	unsigned int group;
+
+	while (kfifo_get(&data->nl_fifo, &event)) {
+		groups = event.groups;
+		for_each_set_bit(group, &groups, ARRAY_SIZE(psoc4_genl_mcgrps))
+			psoc4_nl_emit(data->client, &event, group);
+	}
+}
+
+// Queue the events of one frame for the netlink worker
+// Called with the event lock held, after the frame was handled. The event lock
+// makes this the only producer and the worker is the only consumer, so the
+// FIFO needs no further locking. The sequence number counts frames, whether
+// or not they were sent.
+void psoc4_nl_queue_event(struct i2c_client *client, struct psoc4_frame *frame)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_nl_event event;
+	u32 seq = data->nl_seq++;
+	u8 groups = 0;
+
+	// Only groups with listeners that want one of the INT_STATUS bits get the event
+	for (unsigned int group = 0; group < ARRAY_SIZE(psoc4_genl_mcgrps); group++) {
+		if ((frame->int_status & psoc4_nl_group_status[group]) &&
+			psoc4_nl_has_listeners(group))
+			groups |= BIT(group);
+	}
+
+	// Nobody listens, skip the event
+	if (!groups)
+		return;
+
+	event.groups = groups;
+	event.seq = seq;
+	event.time = data->event_time;
+	event.frame = *frame;
+
+	// The worker fell behind, the sequence gap tells listeners about the loss
+	if (!kfifo_put(&data->nl_fifo, event)) {
+		atomic_long_inc(&data->nl_drops);
+		return;
+	}
+
+	queue_work(system_wq, &data->nl_work);
+}
+
+// Set the coalescing window, 0 sends every frame at once
+void psoc4_nl_set_coalesce(struct i2c_client *client, unsigned int window_ms)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	mutex_lock(&data->nl_lock);
+	data->nl_coalesce_ms = window_ms;
+	// Events collected with the old window are sent right away
+	psoc4_nl_flush_locked(client);
+	mutex_unlock(&data->nl_lock);
+}
+
+unsigned int psoc4_nl_get_coalesce(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	unsigned int window_ms;
+
+	mutex_lock(&data->nl_lock);
+	window_ms = data->nl_coalesce_ms;
+	mutex_unlock(&data->nl_lock);
+
+	return window_ms;
+}
+
+// Per-device netlink state, set up before the device can report events
+void psoc4_nl_dev_init(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	mutex_init(&data->nl_lock);
+	mutex_init(&data->nl_config_lock);
+	init_waitqueue_head(&data->nl_config_wait);
+	INIT_KFIFO(data->nl_fifo);
+	INIT_WORK(&data->nl_work, psoc4_nl_work);
+	INIT_DELAYED_WORK(&data->nl_flush_work, psoc4_nl_flush_work);
+}
+
+// Accept configuration requests for a device, called once it is set up
+void psoc4_nl_dev_add(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	mutex_lock(&psoc4_nl_devices_lock);
+	list_add_tail(&data->nl_node, &psoc4_nl_devices);
+	mutex_unlock(&psoc4_nl_devices_lock);
+}
+
+// Stop configuration requests and send pending events, called once the
+// device stopped reporting events
+void psoc4_nl_dev_remove(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	mutex_lock(&psoc4_nl_devices_lock);
+	list_del(&data->nl_node);
+	mutex_unlock(&psoc4_nl_devices_lock);
+
+	// New requests no longer find the device, wait for the running ones
+	wait_event(data->nl_config_wait, !READ_ONCE(data->nl_config_users));
+
+	flush_work(&data->nl_work);
+	cancel_delayed_work_sync(&data->nl_flush_work);
+
+	mutex_lock(&data->nl_lock);
+	psoc4_nl_flush_locked(client);
+	mutex_unlock(&data->nl_lock);
+}
+
+static const struct nla_policy psoc4_reg_policy[PSOC4_REG_ATTR_MAX + 1] = {
+	[PSOC4_REG_ATTR_ADDR] = { .type = NLA_U8 },
+	[PSOC4_REG_ATTR_VALUE] = { .type = NLA_U8 },
+};
+
+static const struct nla_policy psoc4_genl_policy[PSOC4_ATTR_MAX + 1] = {
+	[PSOC4_ATTR_DEV_ID] = { .type = NLA_U32 },
+	[PSOC4_ATTR_DEV_NAME] = { .type = NLA_NUL_STRING },
+	[PSOC4_ATTR_CONFIG] = NLA_POLICY_NESTED_ARRAY(psoc4_reg_policy),
+};
+
+// Check whether a register belongs to the configuration set
+// INT_SRC_EN is not part of it: the driver changes its SCAN_COMPLETE and TOUCH
+// bits under the event lock for capture, IIO and hybrid polling, and a raw
+// write would undo that bookkeeping.
+static bool psoc4_nl_is_config_reg(unsigned int reg)
+{
+	return (reg >= REG_SHIELD_EN && reg <= REG_WEAR_DET_EN) ||
+		(reg >= REG_SNS_AUTO_CAL_EN && reg <= REG_SNS_REF_RATE_ALR);
+}
+
+// Find the device addressed by a configuration request and pin it
+// The device list lock is only held for the lookup. The pinned device is not
+// removed before psoc4_nl_put_device(), so the bus I/O of one touchpad does not
+// block requests to, or removal of, the others.
+static struct psoc4_data *psoc4_nl_get_device(struct genl_info *info)
+{
+	struct nlattr *id = info->attrs[PSOC4_ATTR_DEV_ID];
+	struct nlattr *name = info->attrs[PSOC4_ATTR_DEV_NAME];
+	struct psoc4_data *data;
+
+	mutex_lock(&psoc4_nl_devices_lock);
+	list_for_each_entry(data, &psoc4_nl_devices, nl_node) {
+		if ((id && nla_get_u32(id) == data->id) ||
+			(!id && name && !nla_strcmp(name, dev_name(&data->client->dev)))) {
+			WRITE_ONCE(data->nl_config_users, data->nl_config_users + 1);
+			mutex_unlock(&psoc4_nl_devices_lock);
+			return data;
+		}
+	}
+	mutex_unlock(&psoc4_nl_devices_lock);
+
+	NL_SET_ERR_MSG(info->extack, "Unknown device");
+	return NULL;
+}
+
+// Release a device pinned by psoc4_nl_get_device()
+static void psoc4_nl_put_device(struct psoc4_data *data)
+{
+	mutex_lock(&psoc4_nl_devices_lock);
+	WRITE_ONCE(data->nl_config_users, data->nl_config_users - 1);
+	if (!data->nl_config_users)
+		wake_up(&data->nl_config_wait);
+	mutex_unlock(&psoc4_nl_devices_lock);
+}
+
+// Put configuration registers as nested attributes, with the write status if given
+static int psoc4_nl_put_config(struct sk_buff *skb, const u8 *values, const bool *present,
+								const int *status)
+{
+	struct nlattr *config, *reg;
+
+	config = nla_nest_start(skb, PSOC4_ATTR_CONFIG);
+	if (!config)
+		return -EMSGSIZE;
+
+	for (unsigned int i = 0; i < REG_CONFIG_SIZE; i++) {
+		if (!present[i])
+			continue;
+
+		reg = nla_nest_start(skb, PSOC4_ATTR_REG);
+		if (!reg ||
+			nla_put_u8(skb, PSOC4_REG_ATTR_ADDR, REG_CONFIG + i) ||
+			nla_put_u8(skb, PSOC4_REG_ATTR_VALUE, values[i]) ||
+			(status && nla_put_s32(skb, PSOC4_REG_ATTR_STATUS, status[i])))
+			return -EMSGSIZE;
+		nla_nest_end(skb, reg);
+	}
+
+	nla_nest_end(skb, config);
+	return 0;
+}
+
+// Send the reply to a configuration request
+static int psoc4_nl_config_reply(struct genl_info *info, struct psoc4_data *data, u8 cmd,
+								const u8 *values, const bool *present, const int *status)
+{
+	struct sk_buff *reply;
+	void *hdr;
+
+	reply = genlmsg_new(NLMSG_DEFAULT_SIZE, GFP_KERNEL);
+	if (!reply)
+		return -ENOMEM;
+
+	hdr = genlmsg_put_reply(reply, info, &psoc4_genl_family, 0, cmd);
+	if (!hdr ||
+		nla_put_u32(reply, PSOC4_ATTR_DEV_ID, data->id) ||
+		nla_put_string(reply, PSOC4_ATTR_DEV_NAME, dev_name(&data->client->dev)) ||
+		psoc4_nl_put_config(reply, values, present, status)) {
+		nlmsg_free(reply);
+		return -EMSGSIZE;
+	}
+
+	genlmsg_end(reply, hdr);
+	return genlmsg_reply(reply, info);
+}
+
+// PSOC4_CMD_SET_CONFIG: write a set of configuration registers
+// All entries are validated before the first write. The registers are then
+// written in address order, contiguous registers in one bus transaction, and
+// every register reports the result of its transaction.
+static int psoc4_nl_set_config(struct sk_buff *skb, struct genl_info *info)
+{
+	struct nlattr *tb[PSOC4_REG_ATTR_MAX + 1];
+	u8 values[REG_CONFIG_SIZE] = { 0 };
+	bool present[REG_CONFIG_SIZE] = { false };
+	int status[REG_CONFIG_SIZE] = { 0 };
+	struct psoc4_data *data;
+	struct nlattr *entry;
+	unsigned int start, end;
+	int rem, ret;
+	u8 reg;
+
+	if (GENL_REQ_ATTR_CHECK(info, PSOC4_ATTR_CONFIG))
+		return -EINVAL;
+
+	nla_for_each_nested(entry, info->attrs[PSOC4_ATTR_CONFIG], rem) {
+		ret = nla_parse_nested(tb, PSOC4_REG_ATTR_MAX, entry, psoc4_reg_policy,
+								info->extack);
+		if (ret)
+			return ret;
+
+		if (!tb[PSOC4_REG_ATTR_ADDR] || !tb[PSOC4_REG_ATTR_VALUE]) {
+			NL_SET_ERR_MSG_ATTR(info->extack, entry, "Register address or value missing");
+			return -EINVAL;
+		}
+
+		reg = nla_get_u8(tb[PSOC4_REG_ATTR_ADDR]);
+		if (!psoc4_nl_is_config_reg(reg)) {
+			NL_SET_ERR_MSG_ATTR(info->extack, tb[PSOC4_REG_ATTR_ADDR],
+								"Not a configuration register");
+			return -EINVAL;
+		}
+
+		// A register given twice gets the last value
+		values[reg - REG_CONFIG] = nla_get_u8(tb[PSOC4_REG_ATTR_VALUE]);
+		present[reg - REG_CONFIG] = true;
+	}
+
+	data = psoc4_nl_get_device(info);
+	if (!data)
+		return -ENODEV;
+
+	mutex_lock(&data->nl_config_lock);
+
+	for (start = 0; start < REG_CONFIG_SIZE; start = end) {
+		for (end = start; end < REG_CONFIG_SIZE && present[end]; end++)
+			;
+		if (end == start) {
+			end++;
+			continue;
+		}
+
+		ret = psoc4_write_register(data->client, REG_CONFIG + start, &values[start],
+									end - start);
+		if (ret < 0)
+			dev_err(&data->client->dev, "Failed to write registers 0x%02x-0x%02x: %d\n",
+					REG_CONFIG + start, REG_CONFIG + end - 1, ret);
+		for (unsigned int i = start; i < end; i++)
+			status[i] = ret < 0 ? ret : 0;
+	}
+
+	ret = psoc4_nl_config_reply(info, data, PSOC4_CMD_SET_CONFIG, values, present, status);
+	mutex_unlock(&data->nl_config_lock);
+	psoc4_nl_put_device(data);
+	return ret;
+}
+
+// PSOC4_CMD_GET_CONFIG: read all configuration registers
+// The readable configuration registers are read from the device in one
+// transaction, bypassing the register cache.
+static int psoc4_nl_get_config(struct sk_buff *skb, struct genl_info *info)
+{
+	u8 values[REG_CONFIG_SIZE];
+	bool present[REG_CONFIG_SIZE];
+	struct psoc4_data *data;
+	int ret;
+
+	for (unsigned int i = 0; i < REG_CONFIG_SIZE; i++)
+		present[i] = psoc4_nl_is_config_reg(REG_CONFIG + i);
+
+	data = psoc4_nl_get_device(info);
+	if (!data)
+		return -ENODEV;
+
+	mutex_lock(&data->nl_config_lock);
+
+	ret = psoc4_read_config(data->client, values);
+	if (ret < 0) {
+		NL_SET_ERR_MSG(info->extack, "Failed to read configuration registers");
+		goto unlock;
+	}
+
+	ret = psoc4_nl_config_reply(info, data, PSOC4_CMD_GET_CONFIG, values, present, NULL);
+unlock:
+	mutex_unlock(&data->nl_config_lock);
+	psoc4_nl_put_device(data);
+	return ret;
+}
+
+// Configuration changes the device, only allowed to administrators
+static const struct genl_small_ops psoc4_genl_ops[] = {
+	{
+		.cmd = PSOC4_CMD_SET_CONFIG,
+		.flags = GENL_ADMIN_PERM,
+		.doit = psoc4_nl_set_config,
+	},
+	{
+		.cmd = PSOC4_CMD_GET_CONFIG,
+		.flags = GENL_ADMIN_PERM,
+		.doit = psoc4_nl_get_config,
+	},
+};
+
+// The family is shared by all devices, events carry the device id
+static struct genl_family psoc4_genl_family __ro_after_init = {
+	.name = PSOC4_GENL_NAME,
+	.version = PSOC4_GENL_VERSION,
+	.maxattr = PSOC4_ATTR_MAX,
+	.module = THIS_MODULE,
+	.mcgrps = psoc4_genl_mcgrps,
+	.n_mcgrps = ARRAY_SIZE(psoc4_genl_mcgrps),
+	.policy = psoc4_genl_policy,
+	.small_ops = psoc4_genl_ops,
+	.n_small_ops = ARRAY_SIZE(psoc4_genl_ops),
+	.resv_start_op = __PSOC4_CMD_MAX,
+	.bind = psoc4_nl_bind,
+	.unbind = psoc4_nl_unbind,
+};
+
+// Register the generic netlink family, called once at module init
+int psoc4_nl_init(void)
+{
+	int ret;
+
+	ret = genl_register_family(&psoc4_genl_family);
+	if (ret) {
+		pr_err("Netlink: Failed to register family %s: %d\n", PSOC4_GENL_NAME, ret);
+		return ret;
+	}
+
+	pr_debug("Netlink: Registered family %s\n", PSOC4_GENL_NAME);
+	return 0;
+}
+
+void psoc4_nl_exit(void)
+{
+	genl_unregister_family(&psoc4_genl_family);
+	pr_debug("Netlink: Unregistered family %s\n", PSOC4_GENL_NAME);
+}
@@ -0,0 +1,342 @@
+// SPDX-License-Identifier: GPL-2.0 OR MIT
+/*
+ * Copyright (C) 2025, Infineon Technologies AG, or an affiliate of Infineon Technologies AG.
+ * All rights reserved.
+ *
+ * Licensed under either of
+ *
+ * GNU General Public License, Version 2.0 <https://www.gnu.org/licenses/gpl-2.0.html>
+ * MIT license  <http://opensource.org/licenses/MIT>
+ *
+ * at your option.
+ *
+ * When Licensed under the GNU General Public License, Version 2.0 (the "License");
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/gpl-2.0.html>
+ *
+ * When licensed under the MIT license;
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the “Software”), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "i2c-psoc4-driver.h"
+
+// Frame ring of a device
+// Outlives the device while the character device is open or mapped.
+struct psoc4_ring {
+	struct kref ref;
+	wait_queue_head_t wait;
+	struct psoc4_ring_header *header;	// vmalloc_user() area, mapped to user space
+	struct psoc4_ring_frame *frames;	// Records, behind the header page
+	bool dead;				// Device was removed
+};
+
+// Per open file state
+struct psoc4_ring_reader {
+	struct psoc4_ring *ring;
+	struct mutex lock;	// Serializes read() calls
+	u32 tail;		// Index of the next record to read
+};
+
+static void psoc4_ring_release(struct kref *ref)
+{
+	struct psoc4_ring *ring = container_of(ref, struct psoc4_ring, ref);
+
+	vfree(ring->header);
+	kfree(ring);
+}
+
+// Add a frame to the ring of the device
+// Called with the event lock held, which makes this the only writer.
+void psoc4_ring_push(struct i2c_client *client, struct psoc4_frame *frame)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_ring *ring = data->ring;
+	struct psoc4_ring_frame *record;
+	u32 head;
+
+	if (!ring)
+		return;
+
+	head = ring->header->head;
+	record = &ring->frames[head % PSOC4_RING_RECORDS];
+
+	// The slot still holds record head - PSOC4_RING_RECORDS. Order the head
+	// published by the previous push before the stores that overwrite it, so
+	// a reader that sees part of the new record also sees that head and drops
+	// the copy. Pairs with the smp_rmb() in psoc4_ring_read().
+	smp_wmb();
+
+	record->timestamp = ktime_to_ns(data->event_time);
+	record->seq = head;
+	record->gestures = frame->gestures;
+	record->int_status = frame->int_status;
+	record->num_touches = frame->num_touches;
+	for (unsigned int slot = 0; slot < NUM_TOUCH_SLOTS; slot++) {
+		record->touches[slot].x = frame->touches[slot].x;
+		record->touches[slot].y = frame->touches[slot].y;
+		record->touches[slot].z = frame->touches[slot].z;
+	}
+
+	// Publish the record after its content
+	smp_store_release(&ring->header->head, head + 1);
+
+	if (wq_has_sleeper(&ring->wait))
+		wake_up_interruptible(&ring->wait);
+}
+
+static bool psoc4_ring_readable(struct psoc4_ring *ring, u32 tail)
+{
+	return smp_load_acquire(&ring->header->head) != tail || READ_ONCE(ring->dead);
+}
+
+static int psoc4_ring_open(struct inode *inode, struct file *file)
+{
+	// The misc core stores the misc device, it is registered while open runs
+	struct psoc4_data *data = container_of(file->private_data, struct psoc4_data, misc);
+	struct psoc4_ring_reader *reader;
+
+	reader = kzalloc(sizeof(*reader), GFP_KERNEL);
+	if (!reader)
+		return -ENOMEM;
+
+	reader->ring = data->ring;
+	mutex_init(&reader->lock);
+	// Start with the next frame
+	reader->tail = smp_load_acquire(&reader->ring->header->head);
+	kref_get(&reader->ring->ref);
+
+	file->private_data = reader;
+	return nonseekable_open(inode, file);
+}
+
+static int psoc4_ring_file_release(struct inode *inode, struct file *file)
+{
+	struct psoc4_ring_reader *reader = file->private_data;
+
+	kref_put(&reader->ring->ref, psoc4_ring_release);
+	kfree(reader);
+	return 0;
+}
+
+// Read whole records, frames overwritten before they were read are skipped
+static ssize_t psoc4_ring_read(struct file *file, char __user *buf, size_t count, loff_t *ppos)
+{
+	struct psoc4_ring_reader *reader = file->private_data;
+	struct psoc4_ring *ring = reader->ring;
+	struct psoc4_ring_frame record;
+	size_t copied = 0;
+	ssize_t ret;
+	u32 head;
+
+	if (count < sizeof(record))
+		return -EINVAL;
+
+	if (mutex_lock_interruptible(&reader->lock))
+		return -ERESTARTSYS;
+
+	while (copied + sizeof(record) <= count) {
+		head = smp_load_acquire(&ring->header->head);
+		if (head == reader->tail) {
+			if (copied || READ_ONCE(ring->dead))
+				break;
+			if (file->f_flags & O_NONBLOCK) {
+				ret = -EAGAIN;
+				goto unlock;
+			}
+			ret = wait_event_interruptible(ring->wait,
+											psoc4_ring_readable(ring, reader->tail));
+			if (ret)
+				goto unlock;
+			continue;
+		}
+
+		// The slot of the oldest record may be rewritten right now, skip it
+		if (head - reader->tail >= PSOC4_RING_RECORDS)
+			reader->tail = head - (PSOC4_RING_RECORDS - 1);
+
+		record = ring->frames[reader->tail % PSOC4_RING_RECORDS];
+
+		// Drop the record if the driver started to overwrite it while copying
+		// Pairs with the smp_wmb() in psoc4_ring_push().
+		smp_rmb();
+		if (READ_ONCE(ring->header->head) - reader->tail >= PSOC4_RING_RECORDS)
+			continue;
+
+		if (copy_to_user(buf + copied, &record, sizeof(record))) {
+			ret = copied ? copied : -EFAULT;
+			goto unlock;
+		}
+		copied += sizeof(record);
+		reader->tail++;
+	}
+	ret = copied;
+
+unlock:
+	mutex_unlock(&reader->lock);
+	return ret;
+}
+
+static __poll_t psoc4_ring_poll(struct file *file, poll_table *wait)
+{
+	struct psoc4_ring_reader *reader = file->private_data;
+	struct psoc4_ring *ring = reader->ring;
+	__poll_t mask = 0;
+
+	poll_wait(file, &ring->wait, wait);
+
+	if (smp_load_acquire(&ring->header->head) != READ_ONCE(reader->tail))
+		mask |= EPOLLIN | EPOLLRDNORM;
+	if (READ_ONCE(ring->dead))
+		mask |= EPOLLHUP;
+
+	return mask;
+}
+
+// Every mapping holds a reference to the ring
+static void psoc4_ring_vm_open(struct vm_area_struct *vma)
+{
+	struct psoc4_ring *ring = vma->vm_private_data;
+
+	kref_get(&ring->ref);
+}
+
+static void psoc4_ring_vm_close(struct vm_area_struct *vma)
+{
+	struct psoc4_ring *ring = vma->vm_private_data;
+
+	kref_put(&ring->ref, psoc4_ring_release);
+}
+
+static const struct vm_operations_struct psoc4_ring_vm_ops = {
+	.open = psoc4_ring_vm_open,
+	.close = psoc4_ring_vm_close,
+};
+
+// Map the header and the records read-only
+static int psoc4_ring_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct psoc4_ring_reader *reader = file->private_data;
+	struct psoc4_ring *ring = reader->ring;
+	int ret;
+
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	vm_flags_clear(vma, VM_MAYWRITE);
+
+	ret = remap_vmalloc_range(vma, ring->header, vma->vm_pgoff);
+	if (ret)
+		return ret;
+
+	vma->vm_ops = &psoc4_ring_vm_ops;
+	vma->vm_private_data = ring;
+	psoc4_ring_vm_open(vma);
+	return 0;
+}
+
+static const struct file_operations psoc4_ring_fops = {
+	.owner = THIS_MODULE,
+	.open = psoc4_ring_open,
+	.release = psoc4_ring_file_release,
+	.read = psoc4_ring_read,
+	.poll = psoc4_ring_poll,
+	.mmap = psoc4_ring_mmap,
+};
+
+// Create the frame ring and its /dev/psoc4-N character device
+int psoc4_ring_create(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	size_t data_offset = PAGE_ALIGN(sizeof(struct psoc4_ring_header));
+	struct psoc4_ring *ring;
+	int ret;
+
+	ring = kzalloc(sizeof(*ring), GFP_KERNEL);
+	if (!ring)
+		return -ENOMEM;
+
+	ring->header = vmalloc_user(data_offset +
+								PSOC4_RING_RECORDS * sizeof(struct psoc4_ring_frame));
+	if (!ring->header) {
+		kfree(ring);
+		return -ENOMEM;
+	}
+
+	ring->frames = (void *)ring->header + data_offset;
+	ring->header->version = PSOC4_RING_VERSION;
+	ring->header->record_size = sizeof(struct psoc4_ring_frame);
+	ring->header->num_records = PSOC4_RING_RECORDS;
+	ring->header->data_offset = data_offset;
+	kref_init(&ring->ref);
+	init_waitqueue_head(&ring->wait);
+	data->ring = ring;
+
+	data->misc.minor = MISC_DYNAMIC_MINOR;
+	data->misc.name = devm_kasprintf(&client->dev, GFP_KERNEL, "psoc4-%d", data->id);
+	data->misc.fops = &psoc4_ring_fops;
+	data->misc.parent = &client->dev;
+	if (!data->misc.name) {
+		ret = -ENOMEM;
+		goto free_ring;
+	}
+
+	ret = misc_register(&data->misc);
+	if (ret) {
+		dev_err(&client->dev, "Failed to register /dev/%s: %d\n", data->misc.name, ret);
+		goto free_ring;
+	}
+
+	dev_dbg(&client->dev, "Registered /dev/%s\n", data->misc.name);
+	return 0;
+
+free_ring:
+	data->ring = NULL;
+	kref_put(&ring->ref, psoc4_ring_release);
+	return ret;
+}
+
+// Remove the character device, called once the device stopped reporting frames
+// Open files and mappings keep the ring until they are closed.
+void psoc4_ring_remove(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_ring *ring = data->ring;
+
+	if (!ring)
+		return;
+
+	misc_deregister(&data->misc);
+	data->ring = NULL;
+
+	// Readers see end of file
+	WRITE_ONCE(ring->dead, true);
+	wake_up_interruptible(&ring->wait);
+
+	kref_put(&ring->ref, psoc4_ring_release);
+}
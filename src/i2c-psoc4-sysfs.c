@@ -98,7 +98,11 @@ static ssize_t cmd_bit_store(struct device *dev, struct device_attribute *attr,
 // Sysfs attribute for triggering a software reset
 static ssize_t reset_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
 {
-	return cmd_bit_store(dev, attr, buf, count, CMD_BIT_RESET);
+	ssize_t ret = cmd_bit_store(dev, attr, buf, count, CMD_BIT_RESET);
+
+	// Configuration registers return to their stored values
+	psoc4_reg_cache_invalidate(to_i2c_client(dev));
+	return ret;
 }
 static DEVICE_ATTR_WO(reset);
 
@@ -112,7 +116,11 @@ static DEVICE_ATTR_WO(save_capsense);
 // Sysfs attribute for triggering restoration of CAPSENSE configuration
 static ssize_t restore_capsense_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
 {
-	return cmd_bit_store(dev, attr, buf, count, CMD_BIT_RESTORE_CAPSENSE);
+	ssize_t ret = cmd_bit_store(dev, attr, buf, count, CMD_BIT_RESTORE_CAPSENSE);
+
+	// Configuration registers are reloaded from the stored configuration
+	psoc4_reg_cache_invalidate(to_i2c_client(dev));
+	return ret;
 }
 static DEVICE_ATTR_WO(restore_capsense);
 
@@ -133,7 +141,10 @@ static DEVICE_ATTR_WO(short_test);
 // Sysfs attribute for triggering Bootloader Jump
 static ssize_t bootloader_jump_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
 {
-	return cmd_bit_store(dev, attr, buf, count, CMD_BIT_BOOTLOADER_JUMP);
+	ssize_t ret = cmd_bit_store(dev, attr, buf, count, CMD_BIT_BOOTLOADER_JUMP);
+
+	psoc4_reg_cache_invalidate(to_i2c_client(dev));
+	return ret;
 }
 static DEVICE_ATTR_WO(bootloader_jump);
 
@@ -465,58 +476,127 @@ static ssize_t sns_ref_rate_alr_store(struct device *dev, struct device_attribut
 }
 static DEVICE_ATTR_RW(sns_ref_rate_alr);
 
+// Sysfs attribute for register cache statistics (read operation)
+static ssize_t reg_cache_stats_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct psoc4_data *data = i2c_get_clientdata(to_i2c_client(dev));
+
+	return sprintf(buf, "%ld %ld\n", atomic_long_read(&data->reg_cache_stats.hits),
+			atomic_long_read(&data->reg_cache_stats.misses));
+}
+static DEVICE_ATTR_RO(reg_cache_stats);
+
+// Sysfs attribute for I2C retry policy (read operation)
+static ssize_t i2c_retry_policy_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct psoc4_data *data = i2c_get_clientdata(to_i2c_client(dev));
+	struct psoc4_retry_policy policy;
+
+	mutex_lock(&data->lock);
+	policy = data->retry_policy;
+	mutex_unlock(&data->lock);
+
+	return sprintf(buf, "%u %u %u\n", policy.max_retries, policy.delay_us,
+			policy.deadline_ms);
+}
+
+// Sysfs attribute for I2C retry policy (write operation)
+static ssize_t i2c_retry_policy_store(struct device *dev, struct device_attribute *attr,
+			const char *buf, size_t count)
+{
+	struct psoc4_data *data = i2c_get_clientdata(to_i2c_client(dev));
+	struct psoc4_retry_policy policy;
+
+	if (sscanf(buf, "%u %u %u", &policy.max_retries, &policy.delay_us,
+			&policy.deadline_ms) != 3)
+		return -EINVAL;
+
+	// A zero backoff or deadline would spin, large ones sleep with the lock held
+	if (policy.max_retries > PSOC4_RETRY_MAX_RETRIES ||
+		policy.delay_us < 1 || policy.delay_us > PSOC4_RETRY_MAX_DELAY_US ||
+		policy.deadline_ms < 1 || policy.deadline_ms > PSOC4_RETRY_MAX_DEADLINE_MS)
+		return -EINVAL;
+
+	mutex_lock(&data->lock);
+	data->retry_policy = policy;
+	mutex_unlock(&data->lock);
+
+	return count;
+}
+static DEVICE_ATTR_RW(i2c_retry_policy);
+
+// Sysfs attribute for I2C error statistics (read operation)
+static ssize_t i2c_error_stats_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct psoc4_data *data = i2c_get_clientdata(to_i2c_client(dev));
+
+	return sprintf(buf, "%ld %ld %ld %ld\n",
+			atomic_long_read(&data->i2c_error_stats.nack),
+			atomic_long_read(&data->i2c_error_stats.arb_lost),
+			atomic_long_read(&data->i2c_error_stats.timeout),
+			atomic_long_read(&data->i2c_error_stats.other));
+}
+static DEVICE_ATTR_RO(i2c_error_stats);
+
+// Sysfs attribute for the netlink coalescing window (read operation)
+static ssize_t nl_coalesce_ms_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", psoc4_nl_get_coalesce(to_i2c_client(dev)));
+}
+
+// Sysfs attribute for the netlink coalescing window (write operation)
+static ssize_t nl_coalesce_ms_store(struct device *dev, struct device_attribute *attr,
+			const char *buf, size_t count)
+{
+	unsigned int window_ms;
+
+	if (kstrtouint(buf, 0, &window_ms) || window_ms > NL_COALESCE_MAX_MS)
+		return -EINVAL;
+
+	psoc4_nl_set_coalesce(to_i2c_client(dev), window_ms);
+	return count;
+}
+static DEVICE_ATTR_RW(nl_coalesce_ms);
 
 // Sysfs attribute for DFU update operation (read operation)
 static ssize_t dfu_update_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-	bool dfu_status = psoc4_dfu_get_status();
+	bool dfu_status = psoc4_dfu_get_status(to_i2c_client(dev));
 
 	return sprintf(buf, "%s\n", dfu_status ? "Success" : "Failure");
 }
 
 // Sysfs attribute for DFU update operation (write operation)
+// Takes the name of the image, relative to the firmware search path
 static ssize_t dfu_update_store(struct device *dev, struct device_attribute *attr,
 			const char *buf, size_t count)
 {
-	struct path p;
 	struct i2c_client *client = to_i2c_client(dev);
-	static char dfu_file_path[PATH_MAX];
+	char *fw_buf, *fw_name;
 	int ret;
 
 	if (count > PATH_MAX) {
-		dev_err(&client->dev, "DFU file path too long\n");
+		dev_err(&client->dev, "DFU firmware name too long\n");
 		return -EINVAL;
 	}
 
-	strscpy(dfu_file_path, buf, count);
-	if (dfu_file_path[count - 1] == '\n')
-		dfu_file_path[count - 1] = '\0';
-	else
-		dfu_file_path[count] = '\0';
-
-	ret = kern_path(dfu_file_path, LOOKUP_FOLLOW, &p);
-	if (ret < 0) {
-		dev_err(&client->dev,
-				"File does not exist or cannot be followed: %s\n",
-				dfu_file_path);
-		return ret;
-	}
+	fw_buf = kmemdup_nul(buf, count, GFP_KERNEL);
+	if (!fw_buf)
+		return -ENOMEM;
 
-	ret = psoc4_dfu_start(client);
-	if (ret < 0) {
-		dev_err(&client->dev, "Failed to start DFU update: %d\n", ret);
-		return ret;
+	fw_name = strim(fw_buf);
+	if (!*fw_name) {
+		ret = -EINVAL;
+		goto out;
 	}
 
-	dev_info(&client->dev, "DFU update started with file: %s\n", dfu_file_path);
-
-	ret = psoc4_dfu_program(dfu_file_path);
-	if (ret < 0) {
-		dev_err(&client->dev, "DFU programming failed: %d\n", ret);
-		return ret;
-	}
+	ret = psoc4_dfu_update(client, fw_name);
+	if (ret < 0)
+		dev_err(&client->dev, "DFU update failed: %d\n", ret);
 
-	return count;
+out:
+	kfree(fw_buf);
+	return ret < 0 ? ret : count;
 }
 static DEVICE_ATTR_RW(dfu_update);
 
@@ -610,12 +690,36 @@ int psoc4_sysfs_create(struct i2c_client *client)
 	if (ret)
 		goto remove_sns_ref_rate_act;
 
-	ret = device_create_file(&client->dev, &dev_attr_dfu_update);
+	ret = device_create_file(&client->dev, &dev_attr_reg_cache_stats);
 	if (ret)
 		goto remove_sns_ref_rate_alr;
 
+	ret = device_create_file(&client->dev, &dev_attr_i2c_retry_policy);
+	if (ret)
+		goto remove_reg_cache_stats;
+
+	ret = device_create_file(&client->dev, &dev_attr_i2c_error_stats);
+	if (ret)
+		goto remove_i2c_retry_policy;
+
+	ret = device_create_file(&client->dev, &dev_attr_nl_coalesce_ms);
+	if (ret)
+		goto remove_i2c_error_stats;
+
+	ret = device_create_file(&client->dev, &dev_attr_dfu_update);
+	if (ret)
+		goto remove_nl_coalesce_ms;
+
 	return 0;
 
+remove_nl_coalesce_ms:
+	device_remove_file(&client->dev, &dev_attr_nl_coalesce_ms);
+remove_i2c_error_stats:
+	device_remove_file(&client->dev, &dev_attr_i2c_error_stats);
+remove_i2c_retry_policy:
+	device_remove_file(&client->dev, &dev_attr_i2c_retry_policy);
+remove_reg_cache_stats:
+	device_remove_file(&client->dev, &dev_attr_reg_cache_stats);
 remove_sns_ref_rate_alr:
 	device_remove_file(&client->dev, &dev_attr_sns_ref_rate_alr);
 remove_sns_ref_rate_act:
@@ -681,6 +785,10 @@ void psoc4_sysfs_remove(struct i2c_client *client)
 	device_remove_file(&client->dev, &dev_attr_sns_filt_cfg);
 	device_remove_file(&client->dev, &dev_attr_sns_ref_rate_act);
 	device_remove_file(&client->dev, &dev_attr_sns_ref_rate_alr);
+	device_remove_file(&client->dev, &dev_attr_reg_cache_stats);
+	device_remove_file(&client->dev, &dev_attr_i2c_retry_policy);
+	device_remove_file(&client->dev, &dev_attr_i2c_error_stats);
+	device_remove_file(&client->dev, &dev_attr_nl_coalesce_ms);
 	device_remove_file(&client->dev, &dev_attr_dfu_update);
 
 	sysfs_remove_link(&client->dev.parent->kobj, "psoc4-capsense");
@@ -51,59 +51,220 @@
 #include "i2c-psoc4-driver.h"
 #include <linux/delay.h>
 
+#include <linux/ktime.h>
+#include <linux/unaligned.h>
+
 #define MAX_RETRIES 5
-#define RETRY_DELAY_MS 5
+#define RETRY_DELAY_US 100
+#define RETRY_DEADLINE_MS 20
+
+/* Setting the default retry policy */
+void psoc4_retry_policy_init(struct psoc4_retry_policy *policy)
+{
+	policy->max_retries = MAX_RETRIES;
+	policy->delay_us = RETRY_DELAY_US;
+	policy->deadline_ms = RETRY_DEADLINE_MS;
+}
+
+/* Classifying a failed I2C transfer
+ * Counts the error in its class and returns true if it is worth retrying:
+ * NACKs (device busy), lost arbitration, timeouts and generic bus errors.
+ */
+static bool i2c_classify_error(struct psoc4_i2c_error_stats *stats, int err)
+{
+	switch (err) {
+	case -ENXIO:
+	case -EREMOTEIO:
+		atomic_long_inc(&stats->nack);
+		return true;
+	case -EAGAIN:
+		atomic_long_inc(&stats->arb_lost);
+		return true;
+	case -ETIMEDOUT:
+		atomic_long_inc(&stats->timeout);
+		return true;
+	case -EIO:
+		atomic_long_inc(&stats->other);
+		return true;
+	default:
+		atomic_long_inc(&stats->other);
+		return false;
+	}
+}
 
 /* Safe I2C transfer with retries
  * This function attempts to transfer I2C messages with retries in case of errors.
  * It is useful for handling transient errors like bus errors or device not responding.
+ * Retries back off exponentially and stop at the retry limit or at the deadline
+ * of the call, whichever comes first. Must be called with the device lock held.
  */
 int i2c_safe_transfer(struct i2c_client *client, struct i2c_msg *msgs, int num)
 {
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct psoc4_retry_policy *policy = &data->retry_policy;
+	ktime_t deadline = ktime_add_ms(ktime_get(), policy->deadline_ms);
+	unsigned int delay_us = policy->delay_us;
 	int ret, retries = 0;
 
-	while (retries < MAX_RETRIES) {
+	for (;;) {
 		ret = i2c_transfer(client->adapter, msgs, num);
-		if (ret == num)
-			return num;
+		if (ret >= 0)
+			return ret;
 
 		dev_dbg(&client->dev, "I2C transfer failed (attempt %d, error: %d)\n",
 				retries + 1, ret);
-		if (ret == -EREMOTEIO || ret == -EIO) {
-			msleep(RETRY_DELAY_MS);
-			retries++;
-			continue;
-		}
-		return ret;
+		if (!i2c_classify_error(&data->i2c_error_stats, ret))
+			return ret;
+
+		if (retries >= policy->max_retries ||
+			ktime_after(ktime_add_us(ktime_get(), delay_us), deadline))
+			break;
+
+		usleep_range(delay_us, delay_us + delay_us / 2);
+		delay_us = min_t(unsigned int, delay_us * 2, PSOC4_RETRY_MAX_DELAY_US);
+		retries++;
 	}
 
 	dev_err(&client->dev, "I2C transfer failed after %d retries, error: %d\n", retries, ret);
 	return ret;
 }
 
-/* Reading data from a register */
-int psoc4_read_register(struct i2c_client *client, u8 reg_address, u8 *buffer, int count)
+/* Registers readable over the bus */
+static const struct regmap_range psoc4_rd_ranges[] = {
+	regmap_reg_range(REG_FW_VER, REG_WEAR_DET_EN),
+	regmap_reg_range(REG_SNS_AUTO_CAL_EN, PSOC4_REG_MAX),
+};
+
+static const struct regmap_access_table psoc4_rd_table = {
+	.yes_ranges = psoc4_rd_ranges,
+	.n_yes_ranges = ARRAY_SIZE(psoc4_rd_ranges),
+};
+
+/* Registers writable over the bus */
+static const struct regmap_range psoc4_wr_ranges[] = {
+	regmap_reg_range(REG_CMD, REG_CMD + REG_CMD_SIZE - 1),
+	regmap_reg_range(REG_INT_SRC_EN, REG_INT_STATUS),
+	regmap_reg_range(REG_SHIELD_EN, REG_WEAR_DET_EN),
+	regmap_reg_range(REG_SNS_AUTO_CAL_EN, REG_SNS_REF_RATE_ALR),
+};
+
+static const struct regmap_access_table psoc4_wr_table = {
+	.yes_ranges = psoc4_wr_ranges,
+	.n_yes_ranges = ARRAY_SIZE(psoc4_wr_ranges),
+};
+
+/* Registers changed by the firmware
+ * Reset cause, command, test, status, touch and sensor registers are updated
+ * by the firmware and are never served from the cache. Firmware version,
+ * configuration registers and NUM_SNS only change on reset, restore or DFU,
+ * after which the cache is dropped.
+ */
+static const struct regmap_range psoc4_volatile_ranges[] = {
+	regmap_reg_range(REG_RST_CAUSE, REG_SHORTED_SNS_ID + REG_SHORTED_SNS_ID_SIZE - 1),
+	regmap_reg_range(REG_INT_STATUS, REG_SCAN_MODE),
+	regmap_reg_range(REG_TCH_FRAME, REG_STORED_FLAG),
+	regmap_reg_range(REG_SNS_RAW, PSOC4_REG_MAX),
+};
+
+static const struct regmap_access_table psoc4_volatile_table = {
+	.yes_ranges = psoc4_volatile_ranges,
+	.n_yes_ranges = ARRAY_SIZE(psoc4_volatile_ranges),
+};
+
+/* Writing a sub-address + data buffer to the device
+ * The buffer must be DMA-safe: either the regmap work buffer or the
+ * per-device transfer buffer.
+ */
+static int psoc4_bus_write(struct i2c_client *client, const u8 *buffer, size_t count)
 {
+	struct i2c_msg msg;
 	int ret;
+
+	/* Message for writing */
+	msg.addr = client->addr;
+	msg.flags = I2C_M_DMA_SAFE; // Write
+	msg.len = count; // MSB + LSB + data
+	msg.buf = (u8 *)buffer;
+
+	/* Write data */
+	ret = i2c_safe_transfer(client, &msg, 1);
+	if (ret < 0) {
+		dev_err(&client->dev, "Failed to write to register 0x%04x (I2C error: %d)\n",
+				buffer[1], ret);
+		return ret;
+	} else if (ret != 1) {
+		dev_err(&client->dev, "Incomplete I2C transfer: expected 1 message, got %d\n",
+				ret);
+		return -EIO;
+	}
+
+	dev_dbg(&client->dev, "Wrote %zu bytes to 0x%04x successfully\n",
+			count - 2, buffer[1]);
+	return 0;
+}
+
+/* Regmap bus write
+ * The buffer is the regmap work buffer holding the 16-bit sub-address
+ * followed by the data.
+ */
+static int psoc4_regmap_write(void *context, const void *data, size_t count)
+{
+	return psoc4_bus_write(context, data, count);
+}
+
+/* Regmap bus gather write
+ * Sub-address and data are linearized into the per-device transfer buffer,
+ * so multi-byte writes do not allocate.
+ */
+static int psoc4_regmap_gather_write(void *context, const void *reg, size_t reg_size,
+				const void *val, size_t val_size)
+{
+	struct i2c_client *client = context;
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	if (reg_size + val_size > PSOC4_XFER_BUF_SIZE)
+		return -EINVAL;
+
+	memcpy(data->xfer_buf, reg, reg_size);
+	memcpy(data->xfer_buf + reg_size, val, val_size);
+
+	return psoc4_bus_write(client, data->xfer_buf, reg_size + val_size);
+}
+
+/* Regmap bus read
+ * Sends the 16-bit sub-address and reads the data with a repeated START.
+ * Both go through the per-device transfer buffer.
+ */
+static int psoc4_regmap_read(void *context, const void *reg_buf, size_t reg_size,
+				void *val_buf, size_t val_size)
+{
+	struct i2c_client *client = context;
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	const u8 *reg = reg_buf;
 	struct i2c_msg msgs[2];
+	int ret;
+
+	if (reg_size + val_size > PSOC4_XFER_BUF_SIZE)
+		return -EINVAL;
+
+	memcpy(data->xfer_buf, reg_buf, reg_size);
 
 	/* Message for sending the register (sub-address) */
 	msgs[0].addr = client->addr;
-	msgs[0].flags = 0; // Write
-	msgs[0].len = 2;   // MSB + LSB
-	msgs[0].buf = (u8[]){ 0x00, reg_address & 0xFF }; // Form the sub-address
+	msgs[0].flags = I2C_M_DMA_SAFE; // Write
+	msgs[0].len = reg_size; // MSB + LSB
+	msgs[0].buf = data->xfer_buf;
 
 	/* Message for reading data */
 	msgs[1].addr = client->addr;
-	msgs[1].flags = I2C_M_RD; // Read
-	msgs[1].len = count;      // Number of bytes to read
-	msgs[1].buf = buffer;     // Buffer for storing data
+	msgs[1].flags = I2C_M_RD | I2C_M_DMA_SAFE; // Read
+	msgs[1].len = val_size;   // Number of bytes to read
+	msgs[1].buf = data->xfer_buf + reg_size;
 
-	/* Sending the sub-address to the device */
 	ret = i2c_safe_transfer(client, msgs, 2);
 	if (ret < 0) {
 		dev_err(&client->dev, "Failed to read register 0x%04x (I2C error: %d)\n",
-				reg_address, ret);
+				reg[1], ret);
 		return ret;
 	} else if (ret != 2) {
 		dev_err(&client->dev, "Incomplete I2C transfer: expected 2 messages, got %d\n",
@@ -111,50 +272,199 @@ int psoc4_read_register(struct i2c_client *client, u8 reg_address, u8 *buffer, i
 		return -EIO;
 	}
 
-	dev_dbg(&client->dev, "Read %d bytes from 0x%04x successfully\n", count, reg_address);
+	memcpy(val_buf, data->xfer_buf + reg_size, val_size);
+
+	dev_dbg(&client->dev, "Read %zu bytes from 0x%04x successfully\n", val_size, reg[1]);
 	return 0;
 }
 
-/* Writing data to a register */
+/* EZI2C bus: 16-bit big-endian sub-address followed by 8-bit data */
+static const struct regmap_bus psoc4_regmap_bus = {
+	.write = psoc4_regmap_write,
+	.gather_write = psoc4_regmap_gather_write,
+	.read = psoc4_regmap_read,
+	.max_raw_read = PSOC4_XFER_BUF_SIZE - 2,
+	.max_raw_write = PSOC4_XFER_BUF_SIZE - 2,
+};
+
+/* Regmap locking
+ * The regmap uses the device lock, which also guards the transfer buffer.
+ */
+static void psoc4_regmap_lock(void *arg)
+{
+	struct psoc4_data *data = arg;
+
+	mutex_lock(&data->lock);
+}
+
+static void psoc4_regmap_unlock(void *arg)
+{
+	struct psoc4_data *data = arg;
+
+	mutex_unlock(&data->lock);
+}
+
+static const struct regmap_config psoc4_regmap_config = {
+	.reg_bits = 16,
+	.val_bits = 8,
+	.reg_format_endian = REGMAP_ENDIAN_BIG,
+	.max_register = PSOC4_REG_MAX,
+	.rd_table = &psoc4_rd_table,
+	.wr_table = &psoc4_wr_table,
+	.volatile_table = &psoc4_volatile_table,
+	.cache_type = REGCACHE_MAPLE,
+};
+
+/* Creating the register map of the device
+ * Requires the driver data to be set as client data and its lock to be
+ * initialized.
+ */
+int psoc4_regmap_init(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	struct regmap_config config = psoc4_regmap_config;
+
+	config.lock = psoc4_regmap_lock;
+	config.unlock = psoc4_regmap_unlock;
+	config.lock_arg = data;
+
+	data->regmap = devm_regmap_init(&client->dev, &psoc4_regmap_bus, client, &config);
+	if (IS_ERR(data->regmap)) {
+		dev_err(&client->dev, "Failed to initialize register map\n");
+		return PTR_ERR(data->regmap);
+	}
+
+	return 0;
+}
+
+/* Dropping all cached values
+ * Must be called whenever the firmware may have changed its configuration
+ * on its own: software reset, CAPSENSE configuration restore or DFU.
+ */
+void psoc4_reg_cache_invalidate(struct i2c_client *client)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	regcache_drop_region(data->regmap, 0, PSOC4_REG_MAX);
+
+	dev_dbg(&client->dev, "Register cache invalidated\n");
+}
+
+/* Updating the cache statistics for a read of cacheable registers */
+static void psoc4_reg_cache_account(struct psoc4_data *data, u8 reg_address, int count)
+{
+	for (unsigned int reg = reg_address; reg < reg_address + count; reg++) {
+		if (regmap_check_range_table(data->regmap, reg, &psoc4_volatile_table))
+			continue;
+
+		if (regcache_reg_cached(data->regmap, reg))
+			atomic_long_inc(&data->reg_cache_stats.hits);
+		else
+			atomic_long_inc(&data->reg_cache_stats.misses);
+	}
+}
+
+/* Reading data from a register
+ * Cached configuration registers are served from the register cache once
+ * they have been read or written; everything else is read from the device.
+ */
+int psoc4_read_register(struct i2c_client *client, u8 reg_address, u8 *buffer, int count)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	psoc4_reg_cache_account(data, reg_address, count);
+
+	return regmap_bulk_read(data->regmap, reg_address, buffer, count);
+}
+
+/* Writing data to a register
+ * Single registers go through the preformatted regmap buffer, longer writes
+ * are sent as one raw block.
+ */
 int psoc4_write_register(struct i2c_client *client, u8 reg_address, const u8 *data, int count)
 {
+	struct psoc4_data *psoc4 = i2c_get_clientdata(client);
+
+	if (count == 1)
+		return regmap_write(psoc4->regmap, reg_address, data[0]);
+
+	return regmap_raw_write(psoc4->regmap, reg_address, data, count);
+}
+
+/* Read-modify-write of a single register */
+int psoc4_update_register(struct i2c_client *client, u8 reg_address, u8 mask, u8 value)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+
+	psoc4_reg_cache_account(data, reg_address, 1);
+
+	return regmap_update_bits(data->regmap, reg_address, mask, value);
+}
+
+/* Reading the configuration block directly from the device
+ * 0x13-0x22 are not readable, so the two readable runs INT_SRC_EN to
+ * WEAR_DET_EN and SNS_AUTO_CAL_EN to SNS_REF_RATE_ALR are read as two
+ * address/read pairs in one bus transaction. The buffer is laid out as
+ * REG_CONFIG with the unreadable gap left zero.
+ */
+int psoc4_read_config(struct i2c_client *client, u8 *buffer)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	const u8 lo_size = REG_WEAR_DET_EN - REG_INT_SRC_EN + 1;
+	const u8 hi_size = REG_SNS_REF_RATE_ALR - REG_SNS_AUTO_CAL_EN + 1;
+	u8 *lo_addr = &data->xfer_buf[0];
+	u8 *hi_addr = &data->xfer_buf[2];
+	u8 *lo = &data->xfer_buf[4];
+	u8 *hi = lo + lo_size;
+	struct i2c_msg msgs[4];
 	int ret;
-	u8 *buffer;
-	struct i2c_msg msg;
 
-	/* Allocate memory for sub-address + data */
-	buffer = kmalloc(count + 2, GFP_KERNEL);
-	if (!buffer)
-		return -ENOMEM;
+	BUILD_BUG_ON(4 + REG_CONFIG_SIZE > PSOC4_XFER_BUF_SIZE);
 
-	/* Form the buffer for writing */
-	buffer[0] = 0x00; // MSB
-	buffer[1] = reg_address & 0xFF;        // LSB
-	memcpy(&buffer[2], data, count);      // Copy data
+	mutex_lock(&data->lock);
 
-	/* Message for writing */
-	msg.addr = client->addr;
-	msg.flags = 0; // Write
-	msg.len = count + 2; // MSB + LSB + data
-	msg.buf = buffer;
+	lo_addr[0] = 0x00;
+	lo_addr[1] = REG_INT_SRC_EN;
+	hi_addr[0] = 0x00;
+	hi_addr[1] = REG_SNS_AUTO_CAL_EN;
 
-	/* Write data */
-	ret = i2c_safe_transfer(client, &msg, 1);
+	msgs[0].addr = client->addr;
+	msgs[0].flags = I2C_M_DMA_SAFE; // Write
+	msgs[0].len = 2;   // MSB + LSB
+	msgs[0].buf = lo_addr;
+
+	msgs[1].addr = client->addr;
+	msgs[1].flags = I2C_M_RD | I2C_M_DMA_SAFE; // Read
+	msgs[1].len = lo_size;
+	msgs[1].buf = lo;
+
+	msgs[2].addr = client->addr;
+	msgs[2].flags = I2C_M_DMA_SAFE; // Write
+	msgs[2].len = 2;   // MSB + LSB
+	msgs[2].buf = hi_addr;
 
+	msgs[3].addr = client->addr;
+	msgs[3].flags = I2C_M_RD | I2C_M_DMA_SAFE; // Read
+	msgs[3].len = hi_size;
+	msgs[3].buf = hi;
+
+	ret = i2c_safe_transfer(client, msgs, ARRAY_SIZE(msgs));
 	if (ret < 0) {
-		dev_err(&client->dev, "Failed to write to register 0x%04x (I2C error: %d)\n",
-				reg_address, ret);
-	} else if (ret != 1) {
-		dev_err(&client->dev, "Incomplete I2C transfer: expected 1 message, got %d\n",
+		dev_err(&client->dev, "Failed to read configuration registers (I2C error: %d)\n",
 				ret);
+		goto unlock;
+	} else if (ret != ARRAY_SIZE(msgs)) {
 		ret = -EIO;
-	} else {
-		dev_dbg(&client->dev, "Wrote %d bytes to 0x%04x successfully\n",
-				count, reg_address);
-		ret = 0;
+		goto unlock;
 	}
 
-	kfree(buffer); // Free memory
+	memset(buffer, 0, REG_CONFIG_SIZE);
+	memcpy(&buffer[REG_INT_SRC_EN - REG_CONFIG], lo, lo_size);
+	memcpy(&buffer[REG_SNS_AUTO_CAL_EN - REG_CONFIG], hi, hi_size);
+	ret = 0;
+
+unlock:
+	mutex_unlock(&data->lock);
 	return ret;
 }
 
@@ -190,3 +500,143 @@ int psoc4_read_gestures(struct i2c_client *client, u32 *gestures)
 
 	return 0;
 }
+
+/* Reading INT_STATUS and the touch report block in one transaction
+ * Both sub-addresses are sent with a repeated START, so the status and the
+ * TCH0/TCH1 coordinates, NUM_TOUCH and GESTURE_DET registers belong to the
+ * same bus transaction and are decoded from a single buffer. The transfer
+ * uses the per-device transfer buffer under the device lock.
+ * INT_STATUS is left for the caller to acknowledge. It is a plain register
+ * without write-1-to-clear, so a clear appended to this transaction would also
+ * drop the bits raised by the firmware while the frame was read.
+ */
+int psoc4_read_frame(struct i2c_client *client, struct psoc4_frame *frame)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	u8 *status_addr = &data->xfer_buf[0];
+	u8 *block_addr = &data->xfer_buf[2];
+	u8 *status = &data->xfer_buf[4];
+	u8 *block = &data->xfer_buf[4 + REG_INT_STATUS_SIZE];
+	struct i2c_msg msgs[4];
+	int num = 0;
+	int ret;
+
+	BUILD_BUG_ON(4 + REG_INT_STATUS_SIZE + REG_TCH_FRAME_SIZE > PSOC4_XFER_BUF_SIZE);
+
+	mutex_lock(&data->lock);
+
+	status_addr[0] = 0x00;
+	status_addr[1] = REG_INT_STATUS;
+	block_addr[0] = 0x00;
+	block_addr[1] = REG_TCH_FRAME;
+
+	/* INT_STATUS sub-address and data */
+	msgs[num].addr = client->addr;
+	msgs[num].flags = I2C_M_DMA_SAFE; // Write
+	msgs[num].len = 2;   // MSB + LSB
+	msgs[num++].buf = status_addr;
+
+	msgs[num].addr = client->addr;
+	msgs[num].flags = I2C_M_RD | I2C_M_DMA_SAFE; // Read
+	msgs[num].len = REG_INT_STATUS_SIZE;
+	msgs[num++].buf = status;
+
+	/* Touch report block sub-address and data */
+	msgs[num].addr = client->addr;
+	msgs[num].flags = I2C_M_DMA_SAFE; // Write
+	msgs[num].len = 2;   // MSB + LSB
+	msgs[num++].buf = block_addr;
+
+	msgs[num].addr = client->addr;
+	msgs[num].flags = I2C_M_RD | I2C_M_DMA_SAFE; // Read
+	msgs[num].len = REG_TCH_FRAME_SIZE;
+	msgs[num++].buf = block;
+
+	ret = i2c_safe_transfer(client, msgs, num);
+	if (ret < 0) {
+		dev_err(&client->dev, "Failed to read touch frame (I2C error: %d)\n", ret);
+		goto unlock;
+	} else if (ret != num) {
+		dev_err(&client->dev, "Incomplete I2C transfer: expected %d messages, got %d\n",
+				num, ret);
+		ret = -EIO;
+		goto unlock;
+	}
+
+	frame->int_status = *status;
+	for (unsigned int slot = 0; slot < NUM_TOUCH_SLOTS; slot++) {
+		u8 *xyz = &block[slot * REG_TCH_XYZ_SIZE_BYTES];
+
+		frame->touches[slot].x = xyz[0] | (xyz[1] << 8);
+		frame->touches[slot].y = xyz[2] | (xyz[3] << 8);
+		frame->touches[slot].z = xyz[4] | (xyz[5] << 8);
+	}
+	frame->num_touches = block[REG_TCH_FRAME_NUM_TOUCH_OFFSET];
+	frame->gestures = block[REG_TCH_FRAME_GESTURE_OFFSET] |
+			(block[REG_TCH_FRAME_GESTURE_OFFSET + 1] << 8) |
+			(block[REG_TCH_FRAME_GESTURE_OFFSET + 2] << 16) |
+			((u32)block[REG_TCH_FRAME_GESTURE_OFFSET + 3] << 24);
+	ret = 0;
+
+unlock:
+	mutex_unlock(&data->lock);
+
+	if (ret == 0)
+		dev_dbg(&client->dev, "Read touch frame: INT_STATUS 0x%02x, %u touches\n",
+				frame->int_status, frame->num_touches);
+	return ret;
+}
+
+/* Reading the number of sensors
+ * NUM_SNS is served from the register cache after the first read, so it is
+ * read from the device once after probe, reset, restore or DFU.
+ */
+int psoc4_read_num_sns(struct i2c_client *client, u8 *num_sns)
+{
+	struct psoc4_data *data = i2c_get_clientdata(client);
+	int ret;
+
+	ret = psoc4_read_register(client, REG_NUM_SNS, num_sns, REG_NUM_SNS_SIZE);
+	if (ret < 0)
+		return ret;
+
+	if (*num_sns > PSOC4_MAX_SNS) {
+		// Do not keep a value read while the firmware was starting up
+		regcache_drop_region(data->regmap, REG_NUM_SNS, REG_NUM_SNS);
+		dev_err(&client->dev, "Invalid number of sensors: %u\n", *num_sns);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/* Reading raw counts, baselines and Cp measurements of all sensors
+ * The three arrays are adjacent from SNS_RAW and are read in one transfer,
+ * so all values belong to the same scan.
+ */
+int psoc4_read_sns_snapshot(struct i2c_client *client, struct psoc4_sns_snapshot *snap)
+{
+	u8 *bsln, *cp;
+	int ret, i;
+
+	ret = psoc4_read_num_sns(client, &snap->num_sns);
+	if (ret < 0)
+		return ret;
+	if (snap->num_sns == 0)
+		return 0;
+
+	ret = psoc4_read_register(client, REG_SNS_RAW, snap->regs,
+							REG_SNS_DATA_SIZE(snap->num_sns));
+	if (ret < 0)
+		return ret;
+
+	bsln = snap->regs + REG_SNS_RAW_SIZE(snap->num_sns);
+	cp = bsln + REG_SNS_BSLN_SIZE(snap->num_sns);
+	for (i = 0; i < snap->num_sns; i++) {
+		snap->raw[i] = get_unaligned_le16(&snap->regs[2 * i]);
+		snap->bsln[i] = get_unaligned_le16(&bsln[2 * i]);
+		snap->cp[i] = get_unaligned_le32(&cp[4 * i]);
+	}
+
+	return 0;
+}
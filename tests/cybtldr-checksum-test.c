@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+/*
+ * Copyright 2011-2025 Cypress Semiconductor Corporation (an Infineon company)
+ *
+ * Licensed under either of
+ *
+ * Apache License, Version 2.0 <http://www.apache.org/licenses/LICENSE-2.0>)
+ * MIT license  <http://opensource.org/licenses/MIT>)
+ *
+ * at your option.
+ *
+ * When Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * When licensed under the MIT license;
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the “Software”), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* KUnit tests of the bootloader packet checksums
+ * The table driven CRC-16 CCITT and the CRC-32C implementations are pinned to
+ * known check values and compared with the bitwise reference implementations
+ * they replaced, on unaligned buffers of odd length. Both CRC-32C paths are
+ * tested: the slice-by-8 tables and, when available, the kernel crc32c().
+ * The throughput of each path is reported with kunit_info().
+ */
+
+#include <kunit/test.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+
+// The checksum code is built into the test module
+#include "../src/cybootloaderutils/cybtldr_command.c"
+
+#define CHECKSUM_TEST_SIZE		1100
+#define CHECKSUM_BENCH_SIZE		4096
+#define CHECKSUM_BENCH_LOOPS	256
+
+static const u8 check_input[] = "123456789";
+
+// Bitwise CRC-16 CCITT of the original implementation
+static u16 ref_crc16(const u8 *buf, u32 size)
+{
+	u16 crc = 0xffff;
+	u16 tmp;
+	int i;
+
+	while (size-- > 0) {
+		for (i = 0, tmp = *buf++; i < 8; i++, tmp >>= 1) {
+			if ((crc & 0x0001) ^ (tmp & 0x0001))
+				crc = (crc >> 1) ^ 0x8408;
+			else
+				crc >>= 1;
+		}
+	}
+
+	crc = ~crc;
+	return (crc << 8) | (crc >> 8);
+}
+
+#define G0 0x82F63B78
+#define G1 ((G0 >> 1) & 0x7fffffff)
+#define G2 ((G0 >> 2) & 0x3fffffff)
+#define G3 ((G0 >> 3) & 0x1fffffff)
+
+// Nibble table CRC-32C of the original implementation
+static u32 ref_crc32c(const u8 *buf, u32 size)
+{
+	static const u32 table[16] = {
+		0, G3, G2, G2 ^ G3,
+		G1, G1 ^ G3, G1 ^ G2, G1 ^ G2 ^ G3,
+		G0, G0 ^ G3, G0 ^ G2, G0 ^ G2 ^ G3,
+		G0 ^ G1, G0 ^ G1 ^ G3, G0 ^ G1 ^ G2, G0 ^ G1 ^ G2 ^ G3,
+	};
+	u32 crc = 0xFFFFFFFF;
+	int i;
+
+	while (size-- > 0) {
+		crc ^= *buf++;
+		for (i = 1; i >= 0; i--)
+			crc = (crc >> 4) ^ table[crc & 0xF];
+	}
+	return ~crc;
+}
+
+#undef G0
+#undef G1
+#undef G2
+#undef G3
+
+// Deterministic test data
+static void checksum_test_fill(u8 *buf, u32 size)
+{
+	u32 seed = 0x12345678;
+
+	while (size-- > 0) {
+		seed = seed * 1103515245 + 12345;
+		*buf++ = seed >> 16;
+	}
+}
+
+// Lengths around the 8 byte blocks of slice-by-8, at every alignment
+static const u32 checksum_test_lengths[] = { 0, 1, 3, 7, 8, 9, 15, 17, 63, 255, 1025 };
+
+static void checksum_crc16_test(struct kunit *test)
+{
+	u8 *buf = kunit_kmalloc(test, CHECKSUM_TEST_SIZE, GFP_KERNEL);
+	unsigned int i, offset;
+	u32 len;
+
+	KUNIT_ASSERT_NOT_NULL(test, buf);
+	checksum_test_fill(buf, CHECKSUM_TEST_SIZE);
+
+	CyBtldr_SetCheckSumType(CRC_CHECKSUM);
+	KUNIT_EXPECT_EQ(test, CyBtldr_ComputeChecksum16bit((u8 *)check_input, 9), 0x6E90);
+	KUNIT_EXPECT_EQ(test, CyBtldr_ComputeChecksum16bit(buf, 0), 0x0000);
+
+	for (offset = 0; offset < 8; offset++) {
+		for (i = 0; i < ARRAY_SIZE(checksum_test_lengths); i++) {
+			len = checksum_test_lengths[i];
+			KUNIT_EXPECT_EQ(test, CyBtldr_ComputeChecksum16bit(buf + offset, len),
+					ref_crc16(buf + offset, len));
+		}
+	}
+}
+
+static void checksum_sum16_test(struct kunit *test)
+{
+	CyBtldr_SetCheckSumType(SUM_CHECKSUM);
+	KUNIT_EXPECT_EQ(test, CyBtldr_ComputeChecksum16bit((u8 *)check_input, 9), 0xFE23);
+	CyBtldr_SetCheckSumType(CRC_CHECKSUM);
+}
+
+// Compare one CRC-32C implementation with the reference
+static void checksum_crc32c_check(struct kunit *test, u32 (*crc)(const u8 *, u32))
+{
+	u8 *buf = kunit_kmalloc(test, CHECKSUM_TEST_SIZE, GFP_KERNEL);
+	unsigned int i, offset;
+	u32 len;
+
+	KUNIT_ASSERT_NOT_NULL(test, buf);
+	checksum_test_fill(buf, CHECKSUM_TEST_SIZE);
+
+	KUNIT_EXPECT_EQ(test, crc(check_input, 9), 0xE3069283);
+	KUNIT_EXPECT_EQ(test, crc(buf, 0), 0x00000000);
+
+	for (offset = 0; offset < 8; offset++) {
+		for (i = 0; i < ARRAY_SIZE(checksum_test_lengths); i++) {
+			len = checksum_test_lengths[i];
+			KUNIT_EXPECT_EQ(test, crc(buf + offset, len), ref_crc32c(buf + offset, len));
+		}
+	}
+}
+
+static u32 checksum_crc32c_selected(const u8 *buf, u32 size)
+{
+	return CyBtldr_ComputeChecksum32bit((u8 *)buf, size);
+}
+
+#if CYBTLDR_KERNEL_CRC32C
+static u32 checksum_crc32c_kernel(const u8 *buf, u32 size)
+{
+	return ~crc32c(~0U, buf, size);
+}
+#endif /* #if CYBTLDR_KERNEL_CRC32C */
+
+static void checksum_crc32c_slice8_test(struct kunit *test)
+{
+	CyBtldr_InitCrc32cTable();
+	checksum_crc32c_check(test, CyBtldr_Crc32cSlice8);
+}
+
+static void checksum_crc32c_kernel_test(struct kunit *test)
+{
+#if CYBTLDR_KERNEL_CRC32C
+	checksum_crc32c_check(test, checksum_crc32c_kernel);
+#else
+	kunit_skip(test, "kernel CRC-32C is not available");
+#endif /* #if CYBTLDR_KERNEL_CRC32C */
+}
+
+// The implementation selected for the bootloader
+static void checksum_crc32c_selected_test(struct kunit *test)
+{
+	CyBtldr_InitChecksum();
+	checksum_crc32c_check(test, checksum_crc32c_selected);
+}
+
+// Report the throughput of one checksum in MiB/s
+static void checksum_bench(struct kunit *test, const char *name,
+			u32 (*crc)(const u8 *, u32), const u8 *buf)
+{
+	volatile u32 sink = 0;
+	ktime_t start;
+	u64 ns;
+	int i;
+
+	start = ktime_get();
+	for (i = 0; i < CHECKSUM_BENCH_LOOPS; i++)
+		sink ^= crc(buf, CHECKSUM_BENCH_SIZE);
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	kunit_info(test, "%s: %llu MiB/s\n", name,
+			div64_u64((u64)CHECKSUM_BENCH_SIZE * CHECKSUM_BENCH_LOOPS * NSEC_PER_SEC,
+					max_t(u64, ns, 1)) >> 20);
+}
+
+static u32 checksum_crc16_bench(const u8 *buf, u32 size)
+{
+	return CyBtldr_ComputeChecksum16bit((u8 *)buf, size);
+}
+
+static u32 checksum_ref_crc16_bench(const u8 *buf, u32 size)
+{
+	return ref_crc16(buf, size);
+}
+
+static void checksum_throughput_test(struct kunit *test)
+{
+	u8 *buf = kunit_kmalloc(test, CHECKSUM_BENCH_SIZE, GFP_KERNEL);
+
+	KUNIT_ASSERT_NOT_NULL(test, buf);
+	checksum_test_fill(buf, CHECKSUM_BENCH_SIZE);
+
+	CyBtldr_SetCheckSumType(CRC_CHECKSUM);
+	CyBtldr_InitCrc32cTable();
+	checksum_bench(test, "CRC-16 CCITT table", checksum_crc16_bench, buf);
+	checksum_bench(test, "CRC-16 CCITT bitwise", checksum_ref_crc16_bench, buf);
+	checksum_bench(test, "CRC-32C slice-by-8", CyBtldr_Crc32cSlice8, buf);
+#if CYBTLDR_KERNEL_CRC32C
+	checksum_bench(test, "CRC-32C crc32c()", checksum_crc32c_kernel, buf);
+#endif /* #if CYBTLDR_KERNEL_CRC32C */
+	checksum_bench(test, "CRC-32C nibble table", ref_crc32c, buf);
+}
+
+static struct kunit_case cybtldr_checksum_test_cases[] = {
+	KUNIT_CASE(checksum_crc16_test),
+	KUNIT_CASE(checksum_sum16_test),
+	KUNIT_CASE(checksum_crc32c_slice8_test),
+	KUNIT_CASE(checksum_crc32c_kernel_test),
+	KUNIT_CASE(checksum_crc32c_selected_test),
+	KUNIT_CASE(checksum_throughput_test),
+	{}
+};
+
+static struct kunit_suite cybtldr_checksum_test_suite = {
+	.name = "cybtldr-checksum",
+	.test_cases = cybtldr_checksum_test_cases,
+};
+kunit_test_suite(cybtldr_checksum_test_suite);
+
+MODULE_LICENSE("Dual MIT/GPL");
+MODULE_AUTHOR("Cypress Semiconductor Corporation (an Infineon company)");
+MODULE_DESCRIPTION("KUnit tests of the bootloader packet checksums");
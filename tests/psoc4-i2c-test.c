@@ -0,0 +1,338 @@
+// SPDX-License-Identifier: GPL-2.0 OR MIT
+/*
+ * Copyright (C) 2025, Infineon Technologies AG, or an affiliate of Infineon Technologies AG.
+ * All rights reserved.
+ *
+ * Licensed under either of
+ *
+ * GNU General Public License, Version 2.0 <https://www.gnu.org/licenses/gpl-2.0.html>
+ * MIT license  <http://opensource.org/licenses/MIT>
+ *
+ * at your option.
+ *
+ * When Licensed under the GNU General Public License, Version 2.0 (the "License");
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/gpl-2.0.html>
+ *
+ * When licensed under the MIT license;
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the “Software”), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* KUnit tests of the frame and configuration read transactions
+ * The reads run against a model of the device behind a virtual I2C
+ * adapter. The model keeps the 8-bit register space, follows the register
+ * pointer of the messages and logs every message, so the tests can check the
+ * order of the messages of one i2c_transfer and their effect on INT_STATUS.
+ */
+
+#include <kunit/test.h>
+#include <linux/i2c.h>
+
+// The register layer is built into the test module
+#include "../src/psoc4-i2c.c"
+
+#define MODEL_I2C_ADDR		0x0D
+#define MODEL_MAX_LOG		8
+
+// Message seen by the model
+struct psoc4_model_msg {
+	bool read;
+	u8 reg;		// Register pointer at the start of the message
+	u16 len;	// Data bytes, without the sub-address
+	u8 data[4];	// First data bytes of a write
+};
+
+// Device model behind the virtual adapter
+struct psoc4_model {
+	u8 regs[0x100];
+	u8 ptr;
+	// INT_STATUS bits the firmware raises right after INT_STATUS was read
+	u8 raise_after_status;
+	// Number of transfers to fail with -ENXIO before the model answers
+	int nack_transfers;
+	int transfers;
+	int num_msgs;
+	struct psoc4_model_msg log[MODEL_MAX_LOG];
+};
+
+struct psoc4_i2c_test {
+	struct psoc4_model model;
+	struct i2c_adapter adap;
+	struct i2c_client *client;
+	struct psoc4_data *data;
+};
+
+static int psoc4_model_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs, int num)
+{
+	struct psoc4_model *model = i2c_get_adapdata(adap);
+	int i, j;
+
+	model->transfers++;
+	if (model->nack_transfers > 0) {
+		model->nack_transfers--;
+		return -ENXIO;
+	}
+
+	// The log holds the messages of the last transfer
+	model->num_msgs = 0;
+	for (i = 0; i < num; i++) {
+		struct psoc4_model_msg *entry = &model->log[min(i, MODEL_MAX_LOG - 1)];
+		struct i2c_msg *msg = &msgs[i];
+
+		if (msg->addr != MODEL_I2C_ADDR)
+			return -ENXIO;
+
+		entry->read = msg->flags & I2C_M_RD;
+		if (entry->read) {
+			entry->reg = model->ptr;
+			entry->len = msg->len;
+			for (j = 0; j < msg->len; j++)
+				msg->buf[j] = model->regs[model->ptr++];
+			if (entry->reg == REG_INT_STATUS)
+				model->regs[REG_INT_STATUS] |= model->raise_after_status;
+		} else {
+			// 16-bit sub-address, MSB first, followed by the data
+			if (msg->len < 2 || msg->buf[0] != 0x00)
+				return -EIO;
+			model->ptr = msg->buf[1];
+			entry->reg = model->ptr;
+			entry->len = msg->len - 2;
+			memcpy(entry->data, &msg->buf[2], min_t(u16, entry->len, sizeof(entry->data)));
+			for (j = 2; j < msg->len; j++)
+				model->regs[model->ptr++] = msg->buf[j];
+		}
+		model->num_msgs++;
+	}
+
+	return num;
+}
+
+static u32 psoc4_model_functionality(struct i2c_adapter *adap)
+{
+	return I2C_FUNC_I2C;
+}
+
+static const struct i2c_algorithm psoc4_model_algo = {
+	.master_xfer = psoc4_model_xfer,
+	.functionality = psoc4_model_functionality,
+};
+
+// Touch report of one finger and a gesture, with a touch pending in INT_STATUS
+static void psoc4_model_set_touch(struct psoc4_model *model)
+{
+	static const u8 tch0[REG_TCH_XYZ_SIZE_BYTES] = { 0x34, 0x12, 0x78, 0x56, 0x55, 0x00 };
+
+	memcpy(&model->regs[REG_TCH0_POS_X], tch0, sizeof(tch0));
+	model->regs[REG_NUM_TOUCH] = 1;
+	put_unaligned_le32(0x00010002, &model->regs[REG_GESTURE_DET]);
+	model->regs[REG_INT_STATUS] = INT_STATUS_TOUCH_DETECTED | INT_STATUS_GEST_DETECTED;
+}
+
+static int psoc4_i2c_test_init(struct kunit *test)
+{
+	struct psoc4_i2c_test *ctx;
+	int ret;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx);
+
+	ctx->data = kunit_kzalloc(test, sizeof(*ctx->data), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx->data);
+	mutex_init(&ctx->data->lock);
+	psoc4_retry_policy_init(&ctx->data->retry_policy);
+
+	ctx->adap.owner = THIS_MODULE;
+	ctx->adap.algo = &psoc4_model_algo;
+	strscpy(ctx->adap.name, "psoc4-model", sizeof(ctx->adap.name));
+	i2c_set_adapdata(&ctx->adap, &ctx->model);
+	ret = i2c_add_adapter(&ctx->adap);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+
+	ctx->client = i2c_new_dummy_device(&ctx->adap, MODEL_I2C_ADDR);
+	if (IS_ERR(ctx->client)) {
+		i2c_del_adapter(&ctx->adap);
+		KUNIT_FAIL(test, "Failed to create the I2C client: %ld", PTR_ERR(ctx->client));
+		return PTR_ERR(ctx->client);
+	}
+	ctx->data->client = ctx->client;
+	i2c_set_clientdata(ctx->client, ctx->data);
+
+	test->priv = ctx;
+	return 0;
+}
+
+static void psoc4_i2c_test_exit(struct kunit *test)
+{
+	struct psoc4_i2c_test *ctx = test->priv;
+
+	i2c_unregister_device(ctx->client);
+	i2c_del_adapter(&ctx->adap);
+	mutex_destroy(&ctx->data->lock);
+}
+
+// Status read, then touch block read, in one transaction
+static void psoc4_frame_read_order_test(struct kunit *test)
+{
+	struct psoc4_i2c_test *ctx = test->priv;
+	struct psoc4_model *model = &ctx->model;
+	struct psoc4_model_msg *log = model->log;
+	struct psoc4_frame frame;
+	int ret;
+
+	psoc4_model_set_touch(model);
+
+	ret = psoc4_read_frame(ctx->client, &frame);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+
+	// One transaction with repeated STARTs
+	KUNIT_EXPECT_EQ(test, model->transfers, 1);
+	KUNIT_ASSERT_EQ(test, model->num_msgs, 4);
+
+	KUNIT_EXPECT_FALSE(test, log[0].read);
+	KUNIT_EXPECT_EQ(test, log[0].reg, REG_INT_STATUS);
+	KUNIT_EXPECT_EQ(test, log[0].len, 0);
+
+	KUNIT_EXPECT_TRUE(test, log[1].read);
+	KUNIT_EXPECT_EQ(test, log[1].reg, REG_INT_STATUS);
+	KUNIT_EXPECT_EQ(test, log[1].len, REG_INT_STATUS_SIZE);
+
+	KUNIT_EXPECT_FALSE(test, log[2].read);
+	KUNIT_EXPECT_EQ(test, log[2].reg, REG_TCH_FRAME);
+	KUNIT_EXPECT_EQ(test, log[2].len, 0);
+
+	KUNIT_EXPECT_TRUE(test, log[3].read);
+	KUNIT_EXPECT_EQ(test, log[3].reg, REG_TCH_FRAME);
+	KUNIT_EXPECT_EQ(test, log[3].len, REG_TCH_FRAME_SIZE);
+
+	// INT_STATUS is left for the interrupt thread to acknowledge
+	KUNIT_EXPECT_EQ(test, model->regs[REG_INT_STATUS],
+			INT_STATUS_TOUCH_DETECTED | INT_STATUS_GEST_DETECTED);
+
+	// The frame matches the model
+	KUNIT_EXPECT_EQ(test, frame.int_status,
+			INT_STATUS_TOUCH_DETECTED | INT_STATUS_GEST_DETECTED);
+	KUNIT_EXPECT_EQ(test, frame.num_touches, 1);
+	KUNIT_EXPECT_EQ(test, frame.touches[0].x, 0x1234);
+	KUNIT_EXPECT_EQ(test, frame.touches[0].y, 0x5678);
+	KUNIT_EXPECT_EQ(test, frame.touches[0].z, 0x0055);
+	KUNIT_EXPECT_EQ(test, frame.gestures, 0x00010002);
+}
+
+// An event raised by the firmware while the frame is read
+static void psoc4_frame_read_late_event_test(struct kunit *test)
+{
+	struct psoc4_i2c_test *ctx = test->priv;
+	struct psoc4_model *model = &ctx->model;
+	struct psoc4_frame frame;
+	int ret;
+
+	psoc4_model_set_touch(model);
+	model->regs[REG_INT_STATUS] = INT_STATUS_TOUCH_DETECTED;
+	model->raise_after_status = INT_STATUS_SCAN_COMPLETE;
+
+	ret = psoc4_read_frame(ctx->client, &frame);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+	KUNIT_EXPECT_EQ(test, frame.int_status, INT_STATUS_TOUCH_DETECTED);
+
+	// The late event stays pending for the next read
+	KUNIT_EXPECT_TRUE(test, model->regs[REG_INT_STATUS] & INT_STATUS_SCAN_COMPLETE);
+}
+
+// A NACKed transaction is repeated as a whole
+static void psoc4_frame_read_retry_test(struct kunit *test)
+{
+	struct psoc4_i2c_test *ctx = test->priv;
+	struct psoc4_model *model = &ctx->model;
+	struct psoc4_frame frame;
+	int ret;
+
+	psoc4_model_set_touch(model);
+	model->nack_transfers = 2;
+
+	ret = psoc4_read_frame(ctx->client, &frame);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+	KUNIT_EXPECT_EQ(test, model->transfers, 3);
+	KUNIT_EXPECT_EQ(test, atomic_long_read(&ctx->data->i2c_error_stats.nack), 2);
+	KUNIT_EXPECT_TRUE(test, model->log[0].reg == REG_INT_STATUS && !model->log[0].read);
+	KUNIT_EXPECT_EQ(test, frame.int_status,
+			INT_STATUS_TOUCH_DETECTED | INT_STATUS_GEST_DETECTED);
+}
+
+// The configuration read skips the unreadable registers 0x13-0x22
+static void psoc4_config_read_test(struct kunit *test)
+{
+	struct psoc4_i2c_test *ctx = test->priv;
+	struct psoc4_model *model = &ctx->model;
+	struct psoc4_model_msg *log = model->log;
+	u8 values[REG_CONFIG_SIZE];
+	unsigned int reg;
+	int ret;
+
+	for (reg = REG_CONFIG; reg < REG_CONFIG + REG_CONFIG_SIZE; reg++)
+		model->regs[reg] = reg;
+
+	ret = psoc4_read_config(ctx->client, values);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+	KUNIT_EXPECT_EQ(test, model->transfers, 1);
+	KUNIT_ASSERT_EQ(test, model->num_msgs, 4);
+
+	KUNIT_EXPECT_TRUE(test, log[1].read);
+	KUNIT_EXPECT_EQ(test, log[1].reg, REG_INT_SRC_EN);
+	KUNIT_EXPECT_EQ(test, log[1].len, REG_WEAR_DET_EN - REG_INT_SRC_EN + 1);
+	KUNIT_EXPECT_TRUE(test, log[3].read);
+	KUNIT_EXPECT_EQ(test, log[3].reg, REG_SNS_AUTO_CAL_EN);
+	KUNIT_EXPECT_EQ(test, log[3].len, REG_SNS_REF_RATE_ALR - REG_SNS_AUTO_CAL_EN + 1);
+
+	for (reg = REG_CONFIG; reg < REG_CONFIG + REG_CONFIG_SIZE; reg++) {
+		bool gap = reg > REG_WEAR_DET_EN && reg < REG_SNS_AUTO_CAL_EN;
+
+		KUNIT_EXPECT_EQ(test, values[reg - REG_CONFIG], gap ? 0 : reg);
+	}
+}
+
+static struct kunit_case psoc4_i2c_test_cases[] = {
+	KUNIT_CASE(psoc4_frame_read_order_test),
+	KUNIT_CASE(psoc4_frame_read_late_event_test),
+	KUNIT_CASE(psoc4_frame_read_retry_test),
+	KUNIT_CASE(psoc4_config_read_test),
+	{}
+};
+
+static struct kunit_suite psoc4_i2c_test_suite = {
+	.name = "psoc4-i2c",
+	.init = psoc4_i2c_test_init,
+	.exit = psoc4_i2c_test_exit,
+	.test_cases = psoc4_i2c_test_cases,
+};
+kunit_test_suite(psoc4_i2c_test_suite);
+
+MODULE_LICENSE("Dual MIT/GPL");
+MODULE_AUTHOR("Cypress Semiconductor Corporation (an Infineon company)");
+MODULE_DESCRIPTION("KUnit tests of the PSOC4 frame and configuration read transactions");
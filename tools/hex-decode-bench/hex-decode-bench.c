@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+/*
+ * Host benchmark of the cyacd2 hex decoder
+ *
+ * Builds CyBtldr_FromHex() and CyBtldr_FromAscii() from
+ * src/cybootloaderutils/cybtldr_parse.c against small host shims of the
+ * kernel headers and compares them with the range-compare decoder they
+ * replaced:
+ *  - every char value is decoded by CyBtldr_FromHex()
+ *  - random valid rows of every even length decode to the same bytes
+ *  - an invalid char at any position rejects the row with CYRET_ERR_DATA,
+ *    where the old decoder silently decoded it as 0
+ *  - odd lengths are rejected with CYRET_ERR_LENGTH by both decoders
+ * The decode throughput of both decoders is then reported in MiB/s.
+ *
+ * Usage: make run [BENCH_ROWS=<rows>] [BENCH_LOOPS=<loops>]
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cybootloaderutils/cybtldr_parse.h"
+
+#define ROW_CHARS	(MAX_BUFFER_SIZE * 2)
+
+static const char hexDigits[] = "0123456789abcdefABCDEF";
+static int failures;
+
+// Range-compare decoder of the original implementation
+static u8 ref_FromHex(char value)
+{
+	if ('0' <= value && value <= '9')
+		return (u8)(value - '0');
+
+	if ('a' <= value && value <= 'f')
+		return (u8)(10 + value - 'a');
+
+	if ('A' <= value && value <= 'F')
+		return (u8)(10 + value - 'A');
+
+	return 0;
+}
+
+static int ref_FromAscii(u32 bufSize, const char *buffer, u16 *rowSize, u8 *rowData)
+{
+	u16 i;
+	int err = CYRET_SUCCESS;
+
+	if (bufSize & 1)  // Make sure even number of bytes
+		err = CYRET_ERR_LENGTH;
+	else {
+		for (i = 0; i < bufSize / 2; i++)
+			rowData[i] = (ref_FromHex(buffer[i * 2]) << 4) |
+						ref_FromHex(buffer[i * 2 + 1]);
+		*rowSize = i;
+	}
+
+	return err;
+}
+
+#define CHECK(cond, ...) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "FAIL: " __VA_ARGS__); \
+		fputc('\n', stderr); \
+		failures++; \
+	} \
+} while (0)
+
+static void fill_row(char *row, u32 len)
+{
+	u32 i;
+
+	for (i = 0; i < len; i++)
+		row[i] = hexDigits[rand() % (sizeof(hexDigits) - 1)];
+}
+
+static void check_chars(void)
+{
+	int c;
+
+	for (c = 0; c < 256; c++) {
+		u8 expected = isxdigit(c) ? ref_FromHex((char)c) : CYBTLDR_HEX_INVALID;
+
+		CHECK(CyBtldr_FromHex((char)c) == expected, "CyBtldr_FromHex(0x%02x)", c);
+	}
+}
+
+static void check_valid_rows(void)
+{
+	static char row[ROW_CHARS];
+	static u8 data[MAX_BUFFER_SIZE], ref[MAX_BUFFER_SIZE];
+	u16 size, refSize;
+	u32 len;
+	int err;
+
+	for (len = 0; len <= ROW_CHARS; len += 2) {
+		fill_row(row, len);
+		size = refSize = 0xFFFF;
+		err = CyBtldr_FromAscii(len, row, &size, data);
+		CHECK(err == CYRET_SUCCESS, "valid row of %u chars: error %d", len, err);
+		ref_FromAscii(len, row, &refSize, ref);
+		CHECK(size == refSize && memcmp(data, ref, size) == 0,
+				"valid row of %u chars decodes differently", len);
+	}
+}
+
+static void check_invalid_rows(void)
+{
+	static char row[ROW_CHARS];
+	static u8 data[MAX_BUFFER_SIZE];
+	const u32 len = 64;
+	const u32 positions[] = { 0, 1, len / 2, len / 2 + 1, len - 2, len - 1 };
+	unsigned int i;
+	u16 size;
+	int c, err;
+
+	for (c = 0; c < 256; c++) {
+		if (isxdigit(c))
+			continue;
+		for (i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+			fill_row(row, len);
+			row[positions[i]] = (char)c;
+			err = CyBtldr_FromAscii(len, row, &size, data);
+			CHECK(err == CYRET_ERR_DATA, "char 0x%02x at %u: error %d", c, positions[i], err);
+		}
+	}
+
+	for (i = 1; i < 8; i += 2) {
+		CHECK(CyBtldr_FromAscii(i, row, &size, data) == CYRET_ERR_LENGTH,
+				"odd length %u accepted", i);
+		CHECK(ref_FromAscii(i, row, &size, data) == CYRET_ERR_LENGTH,
+				"odd length %u accepted by the reference", i);
+	}
+}
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench(const char *name,
+		int (*decode)(u32, const char *, u16 *, u8 *),
+		const char *rows, u32 numRows, u32 loops)
+{
+	static u8 data[MAX_BUFFER_SIZE];
+	volatile u32 sink = 0;
+	double start, elapsed;
+	u16 size;
+	u32 loop, i;
+
+	start = now_s();
+	for (loop = 0; loop < loops; loop++) {
+		for (i = 0; i < numRows; i++) {
+			decode(ROW_CHARS, rows + (size_t)i * ROW_CHARS, &size, data);
+			sink += data[size - 1];
+		}
+	}
+	elapsed = now_s() - start;
+
+	printf("%-14s %8.1f MiB/s of hex text\n", name,
+			(double)ROW_CHARS * numRows * loops / elapsed / (1 << 20));
+}
+
+int main(int argc, char **argv)
+{
+	u32 numRows = argc > 1 ? strtoul(argv[1], NULL, 0) : 256;
+	u32 loops = argc > 2 ? strtoul(argv[2], NULL, 0) : 200;
+	char *rows;
+
+	srand(1);
+	check_chars();
+	check_valid_rows();
+	check_invalid_rows();
+	if (failures) {
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("All decoder checks passed\n");
+
+	if (!numRows || !loops)
+		return 0;
+
+	rows = malloc((size_t)numRows * ROW_CHARS);
+	if (!rows)
+		return 1;
+	fill_row(rows, numRows * ROW_CHARS);
+
+	printf("%u rows of %u chars, %u loops\n", numRows, ROW_CHARS, loops);
+	bench("range compare", ref_FromAscii, rows, numRows, loops);
+	bench("lookup table", CyBtldr_FromAscii, rows, numRows, loops);
+
+	free(rows);
+	return 0;
+}
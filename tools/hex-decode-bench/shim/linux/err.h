@@ -0,0 +1,3 @@
+/* SPDX-License-Identifier: Apache-2.0 OR MIT */
+/* Host replacement of <linux/err.h> for the hex decoder benchmark */
+#include <errno.h>
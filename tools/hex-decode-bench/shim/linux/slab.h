@@ -0,0 +1,23 @@
+/* SPDX-License-Identifier: Apache-2.0 OR MIT */
+/* Host replacement of <linux/slab.h> for the hex decoder benchmark */
+#ifndef HEX_DECODE_BENCH_SLAB_H
+#define HEX_DECODE_BENCH_SLAB_H
+
+#include <stdlib.h>
+
+#define GFP_KERNEL	0
+
+#define kzalloc(size, flags)	calloc(1, size)
+#define kvmalloc(size, flags)	malloc(size)
+#define kfree(ptr)		free((void *)(ptr))
+#define kvfree(ptr)		free((void *)(ptr))
+
+static inline void *krealloc_array(void *ptr, size_t n, size_t size, int flags)
+{
+	(void)flags;
+	if (size && n > SIZE_MAX / size)
+		return NULL;
+	return realloc(ptr, n * size);
+}
+
+#endif // HEX_DECODE_BENCH_SLAB_H
@@ -0,0 +1,3 @@
+/* SPDX-License-Identifier: Apache-2.0 OR MIT */
+/* Host replacement of <linux/string.h> for the hex decoder benchmark */
+#include <string.h>
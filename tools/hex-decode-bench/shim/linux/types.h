@@ -0,0 +1,16 @@
+/* SPDX-License-Identifier: Apache-2.0 OR MIT */
+/* Host replacement of <linux/types.h> for the hex decoder benchmark */
+#ifndef HEX_DECODE_BENCH_TYPES_H
+#define HEX_DECODE_BENCH_TYPES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int32_t s32;
+
+#endif // HEX_DECODE_BENCH_TYPES_H